@@ -21,9 +21,14 @@ namespace hceEngine
         * Uses alpha-beta pruning and quiescence search to find the best move.
         * This is the recommended function to call if maximum performance is wanted given a
         * predetermined depth and/or timeout time.
+        * With numThreads > 1, additional helper threads search the same position and share
+        * their findings with the main search through the transposition table (Lazy SMP).
+        * May be called from several threads at the same time, e.g. to analyze several positions
+        * at once. The concurrent searches then share the transposition table without locking.
         */
         SearchResult getBestMove(const std::string& FEN, uint8_t depth,
-            int32_t timeoutMilliSeconds = std::numeric_limits<int32_t>::max()) const;
+            int32_t timeoutMilliSeconds = std::numeric_limits<int32_t>::max(),
+            uint32_t numThreads = 1) const;
 
         /**
         * Uses the simplest (and slow) minimax algorithm to find the best move given a FEN.
@@ -49,9 +54,22 @@ namespace hceEngine
         /**
         * Given a FEN, returns the numbe of legal moves down to a certain depth.
         * For large depths, this function may take a long time to return since the number of moves
-        * grows exponentially with the depth.
+        * grows exponentially with the depth. With numThreads > 1, the subtrees below the root
+        * are counted in parallel. With hashSizeMB > 0, the counts of positions that are reached
+        * more than once are looked up in a hash table of (about) that size, which is kept between
+        * calls (until clearHash() is called).
         */
-        std::optional<size_t> getNumLegalMoves(const std::string& FEN, uint8_t depth) const;
+        std::optional<size_t> getNumLegalMoves(const std::string& FEN, uint8_t depth,
+            uint32_t numThreads = 1, size_t hashSizeMB = 0) const;
+
+        /**
+        * Same as getNumLegalMoves(), but with the count split up per legal move in the position
+        * (sometimes known as "divide"). The count of a move is the number of legal moves down to
+        * depth - 1 after the move has been made. Useful for finding which move a wrong total
+        * count comes from.
+        */
+        std::optional<std::vector<MoveCount>> getNumLegalMovesPerMove(const std::string& FEN,
+            uint8_t depth, uint32_t numThreads = 1, size_t hashSizeMB = 0) const;
 
         /**
         * Uses the engines internal static board evaluation function to determine the better side.
@@ -66,6 +84,41 @@ namespace hceEngine
         */
         StaticEvaluationResult evaluateStatic(const std::string& FEN) const;
 
+        /**
+        * The engine remembers analyzed positions between calls to getBestMove(), which makes
+        * consecutive searches in the same game faster. This function makes the engine forget all
+        * of them, e.g. when starting a new game. Must not be called while a search is running.
+        */
+        void clearHash();
+
+        /**
+        * Sets the size of the transposition table (the memory used for remembering analyzed
+        * positions, see clearHash()) to at most sizeMB megabytes, the default is 64MB. Larger
+        * tables help deep searches, and several threads searching at once. Clears the table, and
+        * must not be called while a search is running. The table is only allocated by the first
+        * search after the call, so setting the size before searching never allocates the default
+        * size (and an engine that never searches does not allocate a table at all).
+        */
+        void setHashSizeMB(size_t sizeMB);
+
+        /**
+        * Makes getBestMove() remember the results of deep searches between runs of the program,
+        * in a file at path that is memory mapped (and created with a size of about sizeMB
+        * megabytes if it does not exist, an existing file keeps its size). Searching a position
+        * that was already searched at least as deep returns immediately, and the results of
+        * other analyzed positions make the search faster. The file is not affected by
+        * clearHash(). Returns false (and the engine keeps working without the file) if the file
+        * could not be opened or is not an analysis cache file. Only supported on POSIX systems.
+        * Must not be called while a search is running.
+        */
+        bool openAnalysisCache(const std::string& path, size_t sizeMB = 256);
+
+        /**
+        * Stops using the file opened by openAnalysisCache(), the results stored so far are kept in
+        * the file. Must not be called while a search is running.
+        */
+        void closeAnalysisCache();
+
     private:
         std::unique_ptr<Engine> engine;
     };
@@ -26,11 +26,45 @@ namespace hceEngine
 		PawnPromotionCapture
 	};
 
+	// How the transposition table was used by a search, summed over all search threads. All but
+	// the hashfull are only counted when the engine is built with the HCE_TT_STATS CMake option,
+	// otherwise they are zero.
+	struct TranspositionTableInfo
+	{
+		size_t probes = 0;
+		size_t hits = 0;
+
+		// Hits that were searched at least as deep as the probing node needed.
+		size_t usableHits = 0;
+
+		// Usable hits whose score and bound were enough to return from the node right away.
+		size_t cutoffs = 0;
+
+		size_t stores = 0;
+
+		// Stores that overwrote the entry of another position.
+		size_t replacements = 0;
+
+		// Hits whose best move turned out not to be legal in the position, i.e. that came from
+		// another position with the same key. Only a lower bound of the real number of such false
+		// hits: a false hit is not counted if it cut off the node on its score alone (before its
+		// move was checked), or if its move happened to be legal in the position too.
+		size_t illegalTTMoves = 0;
+
+		// Per mille of (a sample of) the table that holds entries from the search.
+		size_t hashfull = 0;
+	};
+
 	struct EngineInfo
 	{
 		size_t nodesVisited = 0;
 		size_t depthsCompletelyCovered = 0;
 		size_t maxDepthVisited = 0;
+
+		// The share (0 to 1) of the static evaluations that were found in the evaluation cache.
+		float evalCacheHitRate = 0.f;
+
+		TranspositionTableInfo transpositionTable;
 	};
 
 	struct ChessMove
@@ -45,6 +79,12 @@ namespace hceEngine
 		std::string postMoveFEN;
 	};
 
+	struct MoveCount
+	{
+		ChessMove move;
+		size_t numLegalMoves = 0;
+	};
+
 	struct SearchResult
 	{
 		ChessMove move;
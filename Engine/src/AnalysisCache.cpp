@@ -0,0 +1,402 @@
+#include "PrivateInclude/AnalysisCache.h"
+
+#include "PrivateInclude/EngineUtilities.h"
+#include "PrivateInclude/ScoringConstants.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// The file starts with a header, followed by the buckets.
+	struct Header
+	{
+		char magic[8];
+		uint64_t version;
+		uint64_t evaluationFingerprint;
+		uint64_t numBuckets;
+		uint64_t session;
+		uint64_t agedAtSession;
+		uint64_t reserved[2];
+	};
+
+	static_assert(sizeof(Header) == 64, "The buckets should start at a cache line boundary.");
+
+	static constexpr char magic[8] = {'H', 'C', 'E', 'C', 'A', 'C', 'H', 'E'};
+
+	// The version of the file layout, files of other versions are not used.
+	static constexpr uint64_t version = 2;
+
+	// Must be bumped whenever a change to the search or the evaluation code changes the scores
+	// the search returns. Changes to the scoring constants are detected without it.
+	static constexpr uint64_t searchVersion = 1;
+
+	constexpr uint64_t addToFingerprint(uint64_t fingerprint, int64_t value)
+	{
+		// FNV-1a, one byte at a time.
+		for (size_t i = 0; i < sizeof(value); i++)
+		{
+			fingerprint ^= static_cast<uint64_t>(value >> (i * 8)) & 0xff;
+			fingerprint *= 0x100000001b3;
+		}
+
+		return fingerprint;
+	}
+
+	template<size_t size>
+	constexpr uint64_t addToFingerprint(uint64_t fingerprint, const std::array<Score, size>& values)
+	{
+		for (const Score value : values)
+		{
+			fingerprint = addToFingerprint(fingerprint, value);
+		}
+
+		return fingerprint;
+	}
+
+	// Identifies the evaluation the stored scores were found with. The scores in a file made by
+	// another evaluation can not be trusted, so such a file is cleared when opened.
+	constexpr uint64_t createEvaluationFingerprint()
+	{
+		using namespace scoringConstants;
+		uint64_t fingerprint = addToFingerprint(0xcbf29ce484222325, searchVersion);
+		for (const std::array<Score, squares::num>& scores : pieceSquareScores)
+		{
+			fingerprint = addToFingerprint(fingerprint, scores);
+		}
+
+		fingerprint = addToFingerprint(fingerprint, bKingEndgameStaticVals);
+		fingerprint = addToFingerprint(fingerprint, wKingEndgameStaticVals);
+		fingerprint = addToFingerprint(fingerprint, bKingEarlyGameStaticVals);
+		fingerprint = addToFingerprint(fingerprint, wKingEarlyGameStaticVals);
+		for (const Score value : {pawnProtectingKing1RankAwayVal, pawnProtectingKing2RanksAwayVal,
+			minNumOpponentMajorPieceRewardKingSafety, doublePawnsPunishmentVal,
+			pawnIslandPunishmentVal, rookOpenFileVal, trappedRookPenaltyVal,
+			minorPieceProtectedByPawnVal, bishopCoverValPerSquare})
+		{
+			fingerprint = addToFingerprint(fingerprint, value);
+		}
+
+		return fingerprint;
+	}
+
+	static constexpr uint64_t evaluationFingerprint = createEvaluationFingerprint();
+
+	// bits 0-15: best move, 16-31: score, 32-39: depth, 40-47: type and 48-63: the (lower bits of
+	// the) session the entry was stored in.
+	uint64_t toData(const searchHelpers::tp::Element& elem, uint16_t session)
+	{
+		return static_cast<uint64_t>(elem.bestMove.getData()) |
+			static_cast<uint64_t>(static_cast<uint16_t>(elem.score)) << 16 |
+			static_cast<uint64_t>(elem.depth) << 32 |
+			static_cast<uint64_t>(static_cast<uint8_t>(elem.type)) << 40 |
+			static_cast<uint64_t>(session) << 48;
+	}
+
+	searchHelpers::tp::Element toElement(uint64_t data)
+	{
+		searchHelpers::tp::Element elem;
+		elem.bestMove = Move::fromData(static_cast<uint16_t>(data));
+		elem.score = static_cast<Score>(static_cast<uint16_t>(data >> 16));
+		elem.depth = static_cast<Depth>(data >> 32);
+		elem.type = static_cast<int8_t>(static_cast<uint8_t>(data >> 40));
+		return elem;
+	}
+
+	Depth getDepth(uint64_t data)
+	{
+		return static_cast<Depth>(data >> 32);
+	}
+
+	uint16_t getSession(uint64_t data)
+	{
+		return static_cast<uint16_t>(data >> 48);
+	}
+
+	// An entry this many sessions old is the first to be replaced whatever its depth, so there is
+	// no need to tell older entries apart.
+	static constexpr uint16_t maxAge = std::numeric_limits<Depth>::max();
+
+	// The entries only hold the lower 16 bits of the session, which tells their age correctly as
+	// long as they are less than 2^16 sessions old. Such old entries are made younger (see
+	// ageEntries()) at least this often, when possible.
+	static constexpr uint64_t sessionsPerAging = 1 << 15;
+
+	size_t getNumBuckets(size_t sizeMB, size_t bucketSize)
+	{
+		const size_t maxNumBuckets = (sizeMB * 1024 * 1024) / bucketSize;
+
+		// Round down to a power of two so that the bucket index can be found using a bitmask.
+		size_t numBuckets = 1;
+		while (numBuckets * 2 <= maxNumBuckets)
+		{
+			numBuckets *= 2;
+		}
+
+		return numBuckets;
+	}
+}
+
+AnalysisCache::~AnalysisCache()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool AnalysisCache::open([[maybe_unused]] const std::string& path, [[maybe_unused]] size_t sizeMB)
+{
+	EngineUtilities::logE("Analysis cache files are not supported on this platform.");
+	return false;
+}
+
+void AnalysisCache::close()
+{
+}
+
+#else
+
+bool AnalysisCache::open(const std::string& path, size_t sizeMB)
+{
+	close();
+
+	file = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (file < 0)
+	{
+		EngineUtilities::logE("Could not open the analysis cache file: " + path);
+		return false;
+	}
+
+	// Other processes may use the file at the same time, each holding a shared lock while it has
+	// the file open. Only a process that gets the lock exclusively (no one else uses the file) may
+	// create, clear or age the file. The others wait for such a process to finish (an exclusive
+	// lock is only held while opening) and then use the file as it is.
+	const bool isOnlyUser = flock(file, LOCK_EX | LOCK_NB) == 0;
+	if (!isOnlyUser && flock(file, LOCK_SH) != 0)
+	{
+		EngineUtilities::logE("Could not lock the analysis cache file: " + path);
+		close();
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0)
+	{
+		EngineUtilities::logE("Could not read the size of the analysis cache file: " + path);
+		close();
+		return false;
+	}
+
+	size_t fileSize = static_cast<size_t>(fileStat.st_size);
+	if (fileSize > 0)
+	{
+		// The number of buckets follows from the size of the file, the header must agree with it.
+		Header header;
+		const size_t numBuckets = fileSize >= sizeof(Header) ?
+			(fileSize - sizeof(Header)) / sizeof(Bucket) : 0;
+		if (pread(file, &header, sizeof(Header), 0) != static_cast<ssize_t>(sizeof(Header)) ||
+			std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+			numBuckets == 0 || (numBuckets & (numBuckets - 1)) != 0 ||
+			(fileSize - sizeof(Header)) % sizeof(Bucket) != 0 || header.numBuckets != numBuckets)
+		{
+			EngineUtilities::logE("Not a valid analysis cache file: " + path);
+			close();
+			return false;
+		}
+
+		if (header.evaluationFingerprint != evaluationFingerprint)
+		{
+			if (!isOnlyUser)
+			{
+				// Clearing the file would make the mappings of the other processes invalid.
+				EngineUtilities::logE("The analysis cache file: " + path + " was made by another "
+					"version of the engine, and can not be cleared since it is in use.");
+				close();
+				return false;
+			}
+
+			EngineUtilities::logW("The analysis cache file: " + path + " was made by another "
+				"version of the engine, clearing it.");
+			fileSize = 0;
+		}
+	}
+
+	// A new file is filled with zeros, which is an empty table.
+	const bool isNewFile = fileSize == 0;
+	if (isNewFile)
+	{
+		fileSize = sizeof(Header) + getNumBuckets(sizeMB, sizeof(Bucket)) * sizeof(Bucket);
+		if (!isOnlyUser || ftruncate(file, 0) != 0 ||
+			ftruncate(file, static_cast<off_t>(fileSize)) != 0)
+		{
+			// Note: another process only holds an empty file if it failed to create it.
+			EngineUtilities::logE("Could not create the analysis cache file: " + path);
+			close();
+			return false;
+		}
+	}
+
+	void* memory = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	if (memory == MAP_FAILED)
+	{
+		EngineUtilities::logE("Could not map the analysis cache file: " + path);
+		close();
+		return false;
+	}
+
+	mapping = memory;
+	mappingSize = fileSize;
+	buckets = reinterpret_cast<Bucket*>(static_cast<char*>(memory) + sizeof(Header));
+	Header* header = static_cast<Header*>(memory);
+	if (isNewFile)
+	{
+		std::memcpy(header->magic, magic, sizeof(magic));
+		header->version = version;
+		header->evaluationFingerprint = evaluationFingerprint;
+		header->numBuckets = (fileSize - sizeof(Header)) / sizeof(Bucket);
+	}
+
+	bucketMask = header->numBuckets - 1;
+
+	// Each opening of the file is a new session, the entries of older sessions are replaced first.
+	// Processes holding the shared lock may open the file at the same time.
+	static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+		"The session must have the same layout as the plain integer in the file.");
+	const uint64_t fullSession = reinterpret_cast<std::atomic<uint64_t>*>(&header->session)->
+		fetch_add(1, std::memory_order_relaxed) + 1;
+	session = static_cast<uint16_t>(fullSession);
+
+	if (isOnlyUser)
+	{
+		if (fullSession - header->agedAtSession >= sessionsPerAging)
+		{
+			ageEntries();
+			header->agedAtSession = fullSession;
+		}
+
+		// Done changing the file, let other processes use it too.
+		flock(file, LOCK_SH);
+	}
+
+	// The probes are spread all over the file, reading ahead would only waste disk bandwidth.
+	madvise(memory, fileSize, MADV_RANDOM);
+	return true;
+}
+
+void AnalysisCache::close()
+{
+	if (mapping != nullptr)
+	{
+		// The kernel writes the pages back to the file, also after the mapping is gone.
+		munmap(mapping, mappingSize);
+	}
+
+	if (file >= 0)
+	{
+		// Also releases the lock.
+		::close(file);
+	}
+
+	file = -1;
+	mapping = nullptr;
+	mappingSize = 0;
+	buckets = nullptr;
+	bucketMask = 0;
+}
+
+#endif
+
+std::optional<searchHelpers::tp::Element> AnalysisCache::find(Hash64 hash) const
+{
+	assert(isOpen());
+	for (const Entry& entry : getBucket(hash).entries)
+	{
+		// Note: depth 0 is never stored, so such an entry is an empty one.
+		const uint64_t data = entry.data.load(std::memory_order_relaxed);
+		if ((entry.keyXorData.load(std::memory_order_relaxed) ^ data) == hash && getDepth(data) > 0)
+		{
+			return toElement(data);
+		}
+	}
+
+	return {};
+}
+
+void AnalysisCache::store(Hash64 hash, const searchHelpers::tp::Element& elem)
+{
+	assert(isOpen());
+	assert(elem.depth > 0);
+
+	// Use the entry of the same position (or an empty one) if there is one. Otherwise replace the
+	// least valuable entry, where every session an entry has been kept counts as losing a ply.
+	Bucket& bucket = getBucket(hash);
+	Entry* replace = &bucket.entries[0];
+	int32_t replaceValue = std::numeric_limits<int32_t>::max();
+	for (Entry& entry : bucket.entries)
+	{
+		const uint64_t data = entry.data.load(std::memory_order_relaxed);
+		if ((entry.keyXorData.load(std::memory_order_relaxed) ^ data) == hash)
+		{
+			if (getDepth(data) > elem.depth && getSession(data) == session)
+			{
+				// A deeper result from this session is worth more than the new one.
+				return;
+			}
+
+			replace = &entry;
+			break;
+		}
+
+		if (getDepth(data) == 0)
+		{
+			replace = &entry;
+			break;
+		}
+
+		const uint16_t age = std::min(static_cast<uint16_t>(session - getSession(data)), maxAge);
+		const int32_t value = static_cast<int32_t>(getDepth(data)) - age;
+		if (value < replaceValue)
+		{
+			replace = &entry;
+			replaceValue = value;
+		}
+	}
+
+	const uint64_t data = toData(elem, session);
+	replace->data.store(data, std::memory_order_relaxed);
+	replace->keyXorData.store(hash ^ data, std::memory_order_relaxed);
+}
+
+void AnalysisCache::ageEntries()
+{
+	// Entries older than maxAge are all treated the same, so their age can be lowered to maxAge
+	// without changing which entries are replaced first. That keeps the age of every entry below
+	// 2^16 sessions, which is what the 16 bits of the session in the entries can tell.
+	for (size_t i = 0; i <= bucketMask; i++)
+	{
+		for (Entry& entry : buckets[i].entries)
+		{
+			const uint64_t data = entry.data.load(std::memory_order_relaxed);
+			const uint16_t age = static_cast<uint16_t>(session - getSession(data));
+			if (getDepth(data) > 0 && age > maxAge)
+			{
+				const Hash64 hash = entry.keyXorData.load(std::memory_order_relaxed) ^ data;
+				const uint64_t agedData = (data & ~(uint64_t(0xffff) << 48)) |
+					static_cast<uint64_t>(static_cast<uint16_t>(session - maxAge)) << 48;
+				entry.data.store(agedData, std::memory_order_relaxed);
+				entry.keyXorData.store(hash ^ agedData, std::memory_order_relaxed);
+			}
+		}
+	}
+}
@@ -0,0 +1,169 @@
+#include "PrivateInclude/Bitboards.h"
+
+#include "PrivateInclude/MagicValues.h"
+
+#include <cassert>
+#include <vector>
+
+namespace
+{
+	struct Direction
+	{
+		Rank rankStep;
+		File fileStep;
+	};
+
+	static constexpr std::array<Direction, 4> rookDirections = {
+		Direction{ 1, 0 }, Direction{ -1, 0 }, Direction{ 0, 1 }, Direction{ 0, -1 } };
+
+	static constexpr std::array<Direction, 4> bishopDirections = {
+		Direction{ 1, 1 }, Direction{ 1, -1 }, Direction{ -1, 1 }, Direction{ -1, -1 } };
+
+	bool isInsideBoard(int32_t rank, int32_t file)
+	{
+		return rank >= ranks::rank1 && rank <= ranks::rank8 && file >= files::fileA && file <= files::fileH;
+	}
+
+	Bitboard toBitboard(int32_t rank, int32_t file)
+	{
+		return bitboards::toBitboard(static_cast<Square>(rank * files::num + file));
+	}
+
+	// Slow sweep in every direction until a blocker (which is included) or the board edge is hit.
+	Bitboard getSlidingAttacks(Square sq, Bitboard occupied, const std::array<Direction, 4>& directions)
+	{
+		Bitboard attacks = bitboards::empty;
+		for (const Direction& dir : directions)
+		{
+			int32_t rank = ranks::toRank(sq) + dir.rankStep;
+			int32_t file = files::toFile(sq) + dir.fileStep;
+			while (isInsideBoard(rank, file))
+			{
+				const Bitboard bb = toBitboard(rank, file);
+				attacks |= bb;
+				if (occupied & bb)
+				{
+					break;
+				}
+
+				rank += dir.rankStep;
+				file += dir.fileStep;
+			}
+		}
+
+		return attacks;
+	}
+
+	// The squares whos occupancy affects the attacks, i.e. all sweep squares except the board edge.
+	Bitboard getBlockerMask(Square sq, const std::array<Direction, 4>& directions)
+	{
+		Bitboard mask = bitboards::empty;
+		for (const Direction& dir : directions)
+		{
+			int32_t rank = ranks::toRank(sq) + dir.rankStep;
+			int32_t file = files::toFile(sq) + dir.fileStep;
+			while (isInsideBoard(rank + dir.rankStep, file + dir.fileStep))
+			{
+				mask |= toBitboard(rank, file);
+				rank += dir.rankStep;
+				file += dir.fileStep;
+			}
+		}
+
+		return mask;
+	}
+
+	template<size_t tableSize>
+	void initMagics(std::array<bitboards::Magic, squares::num>& magics,
+		std::array<Bitboard, tableSize>& attacks, const std::array<uint64_t, squares::num>& magicNumbers,
+		const std::array<Direction, 4>& directions)
+	{
+		uint32_t offset = 0;
+		for (Square sq = squares::a1; sq < squares::num; sq++)
+		{
+			bitboards::Magic& m = magics[sq];
+			m.mask = getBlockerMask(sq, directions);
+			m.magic = magicNumbers[sq];
+			m.shift = static_cast<uint8_t>(64 - bitboards::popCount(m.mask));
+			m.offset = offset;
+
+			// Enumerate all subsets of the mask (Carry-Rippler trick) and store their attacks.
+			Bitboard subset = bitboards::empty;
+			do
+			{
+				const uint32_t index = m.getIndex(subset);
+				assert(index < tableSize);
+				assert(attacks[index] == bitboards::empty ||
+					attacks[index] == getSlidingAttacks(sq, subset, directions));
+				attacks[index] = getSlidingAttacks(sq, subset, directions);
+				subset = (subset - m.mask) & m.mask;
+			} while (subset != bitboards::empty);
+
+			offset += uint32_t(1) << (64 - m.shift);
+		}
+
+		assert(offset == tableSize);
+	}
+
+	Bitboard getJumpAttacks(Square sq, const std::vector<Direction>& jumps)
+	{
+		Bitboard attacks = bitboards::empty;
+		for (const Direction& jump : jumps)
+		{
+			const int32_t rank = ranks::toRank(sq) + jump.rankStep;
+			const int32_t file = files::toFile(sq) + jump.fileStep;
+			if (isInsideBoard(rank, file))
+			{
+				attacks |= toBitboard(rank, file);
+			}
+		}
+
+		return attacks;
+	}
+}
+
+const bitboards::AttackTables bitboards::attackTables;
+
+bitboards::AttackTables::AttackTables() noexcept
+{
+	rookAttacks.fill(empty);
+	bishopAttacks.fill(empty);
+	initMagics(rookMagics, rookAttacks, magicValues::rook, rookDirections);
+	initMagics(bishopMagics, bishopAttacks, magicValues::bishop, bishopDirections);
+
+	const std::vector<Direction> knightJumps = {
+		{ 2, 1 }, { 1, 2 }, { -1, 2 }, { -2, 1 }, { -2, -1 }, { -1, -2 }, { 1, -2 }, { 2, -1 } };
+	const std::vector<Direction> kingJumps = {
+		{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+	for (Square sq = squares::a1; sq < squares::num; sq++)
+	{
+		knightAttacks[sq] = getJumpAttacks(sq, knightJumps);
+		kingAttacks[sq] = getJumpAttacks(sq, kingJumps);
+		whitePawnAttacks[sq] = getJumpAttacks(sq, { { 1, -1 }, { 1, 1 } });
+		blackPawnAttacks[sq] = getJumpAttacks(sq, { { -1, -1 }, { -1, 1 } });
+	}
+
+	for (Square sq1 = squares::a1; sq1 < squares::num; sq1++)
+	{
+		for (Square sq2 = squares::a1; sq2 < squares::num; sq2++)
+		{
+			betweenSquares[sq1][sq2] = empty;
+			lines[sq1][sq2] = empty;
+			for (const auto* directions : { &rookDirections, &bishopDirections })
+			{
+				if (sq1 == sq2 || !(getSlidingAttacks(sq1, empty, *directions) & toBitboard(sq2)))
+				{
+					continue;
+				}
+
+				// The squares are aligned. Where the attacks of both squares overlap is the line
+				// between them, or (on an empty board) the rest of the line they are both on.
+				betweenSquares[sq1][sq2] = getSlidingAttacks(sq1, toBitboard(sq2), *directions) &
+					getSlidingAttacks(sq2, toBitboard(sq1), *directions);
+				lines[sq1][sq2] = (getSlidingAttacks(sq1, empty, *directions) &
+					getSlidingAttacks(sq2, empty, *directions)) | toBitboard(sq1) | toBitboard(sq2);
+			}
+		}
+	}
+}
@@ -2,367 +2,171 @@
 
 #include "PrivateInclude/EngineUtilities.h"
 #include "PrivateInclude/Move.h"
-#include "PrivateInclude/FastSqLookup.h"
+#include "PrivateInclude/ScoringConstants.h"
+#include "PrivateInclude/PawnHashTable.h"
+#include "PrivateInclude/HashValues.h"
 
 #include <cassert>
-#include <vector>
 #include <array>
 
 /*
-* Note on terminology: 
-* 'vals' are always positive, thus must be negated for black.
-* 'score' takes color into account, so is already negative for black.
+* The evaluation is split in two: the material and piece square score, which the board keeps up to
+* date itself (see BoardState::getPieceSquareScore()), and a few terms that depend on more than a
+* single piece. The latter are grouped by the pieces they depend on, so that the delta of a move
+* only has to recompute the groups that the move touches. The groups work on a set of bitboards
+* rather than on the board, which lets the delta evaluate the board after the move without having
+* to make it.
 */
 
-namespace scoringConstants
-{
-	static constexpr Score pawnProtectingKing1RankAwayVal = 40;
-	static constexpr Score pawnProtectingKing2RanksAwayVal = 20;
-
-	// The minimum number of opponent major pieces that has to be on the board for the king to
-	// be rewarded to be "hidden" to the side of the board behind pawns.
-	static constexpr Score minNumOpponentMajorPieceRewardKingSafety = 2;
-
-	static constexpr Score doublePawnsPunishmentVal = 25;
-	static constexpr Score pawnIslandPunishmentVal = 25;
-
-	static constexpr Score rookOpenFileVal = 40;
-	static constexpr Score trappedRookPenaltyVal = 80;
-
-	static constexpr Score minorPieceProtectedByPawnVal = 10;
-
-	static constexpr Score bishopCoverValPerSquare = 3;
-
-	static constexpr std::array<Score, squares::num>bPawnStaticVals =
-	{
-		180, 180, 180, 200, 200, 180, 180, 180,
-		180, 180, 180, 200, 200, 180, 180, 180,
-		100, 120, 140, 160, 160, 140, 120, 100,
-		100, 110, 120, 140, 140, 120, 110, 100,
-		100, 110, 120, 140, 140, 120, 110, 100,
-		100, 110, 120, 120, 120, 120, 110, 100,
-		100, 110, 110, 110, 110, 110, 110, 100,
-		100, 100, 100, 100, 100, 100, 100, 100
-	};
-
-	static constexpr std::array<Score, squares::num> wPawnStaticVals =
-	{
-		100, 100, 100, 100, 100, 100, 100, 100,
-		100, 110, 110, 110, 110, 110, 110, 100,
-		100, 110, 120, 120, 120, 120, 110, 100,
-		100, 110, 120, 140, 140, 120, 110, 100,
-		100, 110, 120, 140, 140, 120, 110, 100,
-		100, 120, 140, 160, 160, 140, 120, 100,
-		180, 180, 180, 200, 200, 180, 180, 180,
-		180, 180, 180, 200, 200, 180, 180, 180
-	};
-
-	static constexpr std::array<Score, squares::num> bKnightStaticVals =
-	{
-		300, 300, 300, 300, 300, 300, 300, 300,
-		300, 310, 310, 310, 310, 310, 310, 300,
-		300, 310, 320, 320, 320, 320, 310, 300,
-		300, 310, 320, 340, 340, 320, 310, 300,
-		300, 310, 320, 340, 340, 320, 310, 300,
-		300, 310, 320, 320, 320, 320, 310, 300,
-		300, 310, 310, 310, 310, 310, 310, 300,
-		300, 270, 300, 300, 300, 300, 270, 300
-	};
-
-	static constexpr std::array<Score, squares::num> wKnightStaticVals =
-	{
-		300, 270, 300, 300, 300, 300, 270, 300,
-		300, 310, 310, 310, 310, 310, 310, 300,
-		300, 310, 320, 320, 320, 320, 310, 300,
-		300, 310, 320, 340, 340, 320, 310, 300,
-		300, 310, 320, 340, 340, 320, 310, 300,
-		300, 310, 320, 320, 320, 320, 310, 300,
-		300, 310, 310, 310, 310, 310, 310, 300,
-		300, 300, 300, 300, 300, 300, 300, 300
-	};
-
-	static constexpr std::array<Score, squares::num> bBishopStaticVals =
-	{
-		305, 305, 305, 305, 305, 305, 305, 305,
-		305, 315, 315, 315, 315, 315, 315, 305,
-		305, 325, 325, 325, 325, 325, 325, 305,
-		305, 325, 335, 345, 345, 335, 325, 305,
-		305, 325, 335, 345, 345, 335, 325, 305,
-		305, 325, 325, 325, 325, 325, 325, 305,
-		305, 315, 315, 315, 315, 315, 315, 305,
-		305, 305, 275, 305, 305, 275, 305, 305
-	};
-
-	static constexpr std::array<Score, squares::num> wBishopStaticVals =
-	{
-		305, 305, 275, 305, 300, 275, 305, 305,
-		305, 315, 315, 315, 315, 315, 315, 305,
-		305, 325, 325, 325, 325, 325, 325, 305,
-		305, 325, 335, 345, 345, 335, 325, 305,
-		305, 325, 335, 345, 345, 335, 325, 305,
-		305, 325, 325, 325, 325, 325, 325, 305,
-		305, 315, 315, 315, 315, 315, 315, 305,
-		305, 305, 305, 305, 305, 305, 305, 305
-	};
-
-	static constexpr std::array<Score, squares::num> rookStaticVals =
-	{
-		500, 507, 515, 522, 522, 515, 507, 500,
-		500, 507, 515, 522, 522, 515, 507, 500,
-		500, 507, 515, 522, 522, 515, 507, 500,
-		500, 507, 515, 522, 522, 515, 507, 500,
-		500, 507, 515, 522, 522, 515, 507, 500,
-		500, 507, 515, 522, 522, 515, 507, 500,
-		500, 507, 515, 522, 522, 515, 507, 500,
-		500, 507, 515, 522, 522, 515, 507, 500
-	};
-
-	static constexpr std::array<Score, squares::num> bQueenStaticVals =
-	{
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 875, 900, 900, 900, 900
-	};
-
-	static constexpr std::array<Score, squares::num> wQueenStaticVals =
-	{
-		900, 900, 900, 875, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900,
-		900, 900, 900, 900, 900, 900, 900, 900
-	};
-
-	static constexpr std::array<Score, squares::num> bKingEndgameStaticVals =
-	{
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
-		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
-		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
-		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000
-	};
-
-	static constexpr std::array<Score, squares::num> wKingEndgameStaticVals =
-	{
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
-		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
-		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
-		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000
-	};
-
-	static constexpr std::array<Score, squares::num> bKingEarlyGameStaticVals =
-	{
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10050, 10050, 10040, 10000, 10000, 10000, 10050, 10050
-	};
-
-	static constexpr std::array<Score, squares::num> wKingEarlyGameStaticVals =
-	{
-		10050, 10050, 10040, 10000, 10000, 10000, 10050, 10050,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
-		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000
-	};
-}
-
 namespace
 {
-	bool isPawn(Piece piece)
+	using PieceBitboards = BoardState::PieceBitboards;
+
+	constexpr uint16_t toPieceMask(Piece piece)
 	{
-		switch (piece)
-		{
-			case pieces::wP:
-			case pieces::bP:
-				return true;
-			default:
-				return false;
-		}
+		return static_cast<uint16_t>(1 << piece);
 	}
 
-	int8_t getNumNonPawnSquaresInSweep(const BoardState& board, const std::vector<Square>& direction,
-		Square sq)
-	{
-		int8_t num = 0;
-		for (const Square s : direction)
-		{
-			if (!isPawn(board.getPiece(s)))
-			{
-				num += 1;
-			}
-			else
-			{
-				return num;
-			}
-		}
+	constexpr uint16_t pawnsMask = toPieceMask(pieces::wP) | toPieceMask(pieces::bP);
+	constexpr uint16_t knightsMask = toPieceMask(pieces::wN) | toPieceMask(pieces::bN);
+	constexpr uint16_t bishopsMask = toPieceMask(pieces::wB) | toPieceMask(pieces::bB);
+	constexpr uint16_t rooksMask = toPieceMask(pieces::wR) | toPieceMask(pieces::bR);
+	constexpr uint16_t kingsMask = toPieceMask(pieces::wK) | toPieceMask(pieces::bK);
 
-		return num;
-	}
+	// The pieces that each group of terms depends on (the minor pieces group depends on the pawns,
+	// knights and bishops). The king scores also depend on the number of major pieces, which only
+	// changes on captures and promotions.
+	constexpr uint16_t pawnStructureDependencies = pawnsMask | rooksMask;
+	constexpr uint16_t minorPiecesMask = knightsMask | bishopsMask;
+	constexpr uint16_t kingsDependencies = pawnsMask | rooksMask | kingsMask;
 
-	Score getWhiteBishopSquareCoverScore(const BoardState& board, const FastSqLookup& lookup,
-		Square sq)
+	bool isPieceOn(const PieceBitboards& bbs, Piece piece, Square sq)
 	{
-		const Score numSqs =
-			getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsA8()[sq], sq) +
-			getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsH8()[sq], sq) +
-			getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsA1()[sq], sq) +
-			getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsH1()[sq], sq);
-		return numSqs * scoringConstants::bishopCoverValPerSquare;
+		return (bbs[piece] & bitboards::toBitboard(sq)) != bitboards::empty;
 	}
 
-	Score getBlackBishopSquareCoverScore(const BoardState& board, const FastSqLookup& lookup,
-		Square sq)
+	// The number of squares the bishop covers, where only pawns are considered to block it.
+	Score getBishopSquareCoverVal(Bitboard pawns, Square sq)
 	{
-		const Score numSqs =
-			-getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsA8()[sq], sq) -
-			getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsH8()[sq], sq) -
-			getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsA1()[sq], sq) -
-			getNumNonPawnSquaresInSweep(board, lookup.getDiagTowardsH1()[sq], sq);
-		return numSqs * scoringConstants::bishopCoverValPerSquare;
+		const Bitboard covered = bitboards::getBishopAttacks(sq, pawns) & ~pawns;
+		return bitboards::popCount(covered) * scoringConstants::bishopCoverValPerSquare;
 	}
 
-	Score getWhiteMinorPiecePawnProtectedScore(const BoardState& board, const FastSqLookup& lookup,
-		Square sq)
+	Score getWhiteMinorPiecePawnProtectedScore(const PieceBitboards& bbs, Square sq)
 	{
 		using namespace scoringConstants;
 		return 0;
-		// Using black pawn capture pattern here which is not a bug.
-		for (Square sq : lookup.getBlackPawnCaptureSquares()[sq])
-		{
-			if (board.getPiece(sq) == pieces::wP)
-			{
-				return minorPieceProtectedByPawnVal;
-			}
-		}
-
-		return 0;
+		// Using black pawn attacks here which is not a bug.
+		return (bitboards::getBlackPawnAttacks(sq) & bbs[pieces::wP]) != bitboards::empty ?
+			minorPieceProtectedByPawnVal : 0;
 	}
 
-	Score getBlackMinorPiecePawnProtectedScore(const BoardState& board, const FastSqLookup& lookup,
-		Square sq)
+	Score getBlackMinorPiecePawnProtectedScore(const PieceBitboards& bbs, Square sq)
 	{
 		using namespace scoringConstants;
 		return 0;
-		// Using white pawn capture pattern here which is not a bug.
-		for (Square sq : lookup.getWhitePawnCaptureSquares()[sq])
-		{
-			if (board.getPiece(sq) == pieces::bP)
-			{
-				return -minorPieceProtectedByPawnVal;
-			}
-		}
+		// Using white pawn attacks here which is not a bug.
+		return (bitboards::getWhitePawnAttacks(sq) & bbs[pieces::bP]) != bitboards::empty ?
+			-minorPieceProtectedByPawnVal : 0;
+	}
 
-		return 0;
+	// The number of files with pawns on them, that have no pawns on either neighbouring file.
+	int8_t getNumPawnIslandFiles(uint8_t filesOccupied)
+	{
+		const uint8_t isolated = filesOccupied & ~(filesOccupied << 1) & ~(filesOccupied >> 1);
+		return bitboards::popCount(isolated);
 	}
 
-	BoardEvaluator::PreMoveInfo createFromMovingSidePawn(const BoardState& board, Piece movingSidePawn)
+	// Doubled pawns and pawn islands, which only depend on the pawns.
+	PawnHashTable::Element createPawnElement(const PieceBitboards& bbs)
 	{
-		BoardEvaluator::PreMoveInfo info;
+		using namespace scoringConstants;
 
-		for (Square sq = squares::a2; sq <= squares::h7; sq++)
+		PawnHashTable::Element elem;
+		for (File f = files::fileA; f < files::num; f++)
 		{
-			assert(EngineUtilities::isValidPiece(board.getPiece(sq)));
-			assert(EngineUtilities::isNonNoneSquare(sq));
+			// Every pawn on a file, except for the first one, is punished for being doubled.
+			const Bitboard file = bitboards::fileA << f;
+			const int8_t numWhite = bitboards::popCount(bbs[pieces::wP] & file);
+			if (numWhite > 0)
+			{
+				elem.whiteFiles |= 1 << f;
+				elem.score -= (numWhite - 1) * doublePawnsPunishmentVal;
+			}
 
-			if (board.getPiece(sq) == movingSidePawn)
+			const int8_t numBlack = bitboards::popCount(bbs[pieces::bP] & file);
+			if (numBlack > 0)
 			{
-				info.movingSidePawnsFileOccupation[files::toFile(sq)] = true;
+				elem.blackFiles |= 1 << f;
+				elem.score += (numBlack - 1) * doublePawnsPunishmentVal;
 			}
 		}
 
-		return info;
+		elem.score -= getNumPawnIslandFiles(elem.whiteFiles) * pawnIslandPunishmentVal;
+		elem.score += getNumPawnIslandFiles(elem.blackFiles) * pawnIslandPunishmentVal;
+		return elem;
 	}
 
-	Score getPawnIslandsVal(const std::array<bool, files::num>& filesOccupied, Score val)
+	PawnHashTable::Element getPawnElement(const PieceBitboards& bbs, Hash64 pawnHash,
+		PawnHashTable& pawnHashTable)
 	{
-		Score score = 0;
-		if (filesOccupied[files::fileA] && !filesOccupied[files::fileB])
+		if (const auto elem = pawnHashTable.find(pawnHash))
 		{
-			score += val;
+			return *elem;
 		}
 
-		if (!filesOccupied[files::fileG] && filesOccupied[files::fileH])
-		{
-			score += val;
-		}
+		const PawnHashTable::Element elem = createPawnElement(bbs);
+		pawnHashTable.store(pawnHash, elem);
+		return elem;
+	}
 
-		for (File f = files::fileC; f < files::num; f++)
-		{
-			if (!filesOccupied[(size_t)f - 2] && filesOccupied[(size_t)f - 1] && !filesOccupied[f])
-			{
-				score += val;
-			}
-		}
+	Hash64 getPawnHashValue(Piece piece, Square sq)
+	{
+		return hashValues::isPawn(piece) ? hashValues::values[hashValues::getHashIndex(sq, piece)] : 0;
+	}
 
-		return score;
+	// Knights, bishops, rooks and queens.
+	int8_t getNumWhiteMajorPieces(const PieceBitboards& bbs)
+	{
+		return bitboards::popCount(bbs[pieces::wQ] | bbs[pieces::wR] | bbs[pieces::wB] |
+			bbs[pieces::wN]);
 	}
 
-	bool isNonPawnNonKing(Piece piece)
+	int8_t getNumBlackMajorPieces(const PieceBitboards& bbs)
 	{
-		switch (piece)
-		{
-			case pieces::wP:
-			case pieces::bP:
-			case pieces::wK:
-			case pieces::bK:
-				return false;
-			default:
-				return true;
-		}
+		return bitboards::popCount(bbs[pieces::bQ] | bbs[pieces::bR] | bbs[pieces::bB] |
+			bbs[pieces::bN]);
 	}
 
-	Score getWhiteKingScore(const BoardState& board, int8_t numBlackMajorPieces)
+	Score getWhiteKingScore(const PieceBitboards& bbs, int8_t numBlackMajorPieces)
 	{
 		using namespace scoringConstants;
 
+		const Square kingSq = bitboards::lsb(bbs[pieces::wK]);
 		if (numBlackMajorPieces < minNumOpponentMajorPieceRewardKingSafety)
 		{
 			// The kBaseVal is baked into the array.
-			return wKingEndgameStaticVals[board.getWhiteKingSquare()];
+			return wKingEndgameStaticVals[kingSq];
 		}
 
 		// Non-endgame: reward king protection.
 		Score score = 0;
-		switch (board.getWhiteKingSquare())
+		switch (kingSq)
 		{
 		case squares::a1:
 		case squares::b1:
 		{
-			if (board.getPiece(squares::a2) == pieces::wP) { score += pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::a3) == pieces::wP) { score += pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::wP, squares::a2)) { score += pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::wP, squares::a3)) { score += pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::b2) == pieces::wP) { score += pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::b3) == pieces::wP) { score += pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::wP, squares::b2)) { score += pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::wP, squares::b3)) { score += pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::c2) == pieces::wP) { score += pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::c3) == pieces::wP) { score += pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::wP, squares::c2)) { score += pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::wP, squares::c3)) { score += pawnProtectingKing2RanksAwayVal; }
 
 			// Trapped rook penalty.
-			if (board.getPiece(squares::a1) == pieces::wR)
+			if (isPieceOn(bbs, pieces::wR, squares::a1))
 			{
 				score -= trappedRookPenaltyVal;
 			}
@@ -371,54 +175,55 @@ namespace
 		case squares::g1:
 		case squares::h1:
 		{
-			if (board.getPiece(squares::f2) == pieces::wP) { score += pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::f3) == pieces::wP) { score += pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::wP, squares::f2)) { score += pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::wP, squares::f3)) { score += pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::g2) == pieces::wP) { score += pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::g3) == pieces::wP) { score += pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::wP, squares::g2)) { score += pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::wP, squares::g3)) { score += pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::h2) == pieces::wP) { score += pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::h3) == pieces::wP) { score += pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::wP, squares::h2)) { score += pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::wP, squares::h3)) { score += pawnProtectingKing2RanksAwayVal; }
 
 			// Trapped rook penalty.
-			if (board.getPiece(squares::h1) == pieces::wR)
+			if (isPieceOn(bbs, pieces::wR, squares::h1))
 			{
 				score -= trappedRookPenaltyVal;
 			}
 		}
 		}
 
-		return score + wKingEarlyGameStaticVals[board.getWhiteKingSquare()];
+		return score + wKingEarlyGameStaticVals[kingSq];
 	}
 
-	Score getBlackKingScore(const BoardState& board, int8_t numWhiteMajorPieces)
+	Score getBlackKingScore(const PieceBitboards& bbs, int8_t numWhiteMajorPieces)
 	{
 		using namespace scoringConstants;
 
+		const Square kingSq = bitboards::lsb(bbs[pieces::bK]);
 		if (numWhiteMajorPieces < minNumOpponentMajorPieceRewardKingSafety)
 		{
 			// The kBaseVal is baked into the array.
-			return -bKingEndgameStaticVals[board.getBlackKingSquare()];
+			return -bKingEndgameStaticVals[kingSq];
 		}
 
 		// Non-endgame: reward king protection.
 		Score score = 0;
-		switch (board.getBlackKingSquare())
+		switch (kingSq)
 		{
 		case squares::a8:
 		case squares::b8:
 		{
-			if (board.getPiece(squares::a7) == pieces::bP) { score -= pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::a6) == pieces::bP) { score -= pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::bP, squares::a7)) { score -= pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::bP, squares::a6)) { score -= pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::b7) == pieces::bP) { score -= pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::b6) == pieces::bP) { score -= pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::bP, squares::b7)) { score -= pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::bP, squares::b6)) { score -= pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::c7) == pieces::bP) { score -= pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::c6) == pieces::bP) { score -= pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::bP, squares::c7)) { score -= pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::bP, squares::c6)) { score -= pawnProtectingKing2RanksAwayVal; }
 
 			// Trapped rook penalty.
-			if (board.getPiece(squares::a8) == pieces::bR)
+			if (isPieceOn(bbs, pieces::bR, squares::a8))
 			{
 				score += trappedRookPenaltyVal;
 			}
@@ -427,299 +232,198 @@ namespace
 		case squares::g8:
 		case squares::h8:
 		{
-			if (board.getPiece(squares::f7) == pieces::bP) { score -= pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::f6) == pieces::bP) { score -= pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::bP, squares::f7)) { score -= pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::bP, squares::f6)) { score -= pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::g7) == pieces::bP) { score -= pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::g6) == pieces::bP) { score -= pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::bP, squares::g7)) { score -= pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::bP, squares::g6)) { score -= pawnProtectingKing2RanksAwayVal; }
 
-			if (board.getPiece(squares::h7) == pieces::bP) { score -= pawnProtectingKing1RankAwayVal; }
-			else if (board.getPiece(squares::h6) == pieces::bP) { score -= pawnProtectingKing2RanksAwayVal; }
+			if (isPieceOn(bbs, pieces::bP, squares::h7)) { score -= pawnProtectingKing1RankAwayVal; }
+			else if (isPieceOn(bbs, pieces::bP, squares::h6)) { score -= pawnProtectingKing2RanksAwayVal; }
 
 			// Trapped rook penalty.
-			if (board.getPiece(squares::h8) == pieces::bR)
+			if (isPieceOn(bbs, pieces::bR, squares::h8))
 			{
 				score += trappedRookPenaltyVal;
 			}
 		}
 		}
 
-		return score - bKingEarlyGameStaticVals[board.getBlackKingSquare()];
-	}
-
-	Score getWhiteKnightMoveDeltaScore(const BoardState& board, const Move& move, const FastSqLookup& lookup)
-	{
-		using namespace scoringConstants;
-		Score score = wKnightStaticVals[move.toSquare] - wKnightStaticVals[move.fromSquare];
-		score += getWhiteMinorPiecePawnProtectedScore(board, lookup, move.toSquare);
-		score -= getWhiteMinorPiecePawnProtectedScore(board, lookup, move.fromSquare);
-		return score;
-	}
-
-	Score getBlackKnightMoveDeltaScore(const BoardState& board, const Move& move, const FastSqLookup& lookup)
-	{
-		using namespace scoringConstants;
-		Score score = -bKnightStaticVals[move.toSquare] + bKnightStaticVals[move.fromSquare];
-		score += getBlackMinorPiecePawnProtectedScore(board, lookup, move.toSquare);
-		score -= getBlackMinorPiecePawnProtectedScore(board, lookup, move.fromSquare);
-		return score;
+		return score - bKingEarlyGameStaticVals[kingSq];
 	}
 
-	Score getWhiteBishopMoveDeltaScore(const BoardState& board, const Move& move,
-		const FastSqLookup& lookup)
+	// Doubled pawns, pawn islands and rooks on open files.
+	Score getPawnStructureScore(const PieceBitboards& bbs, Hash64 pawnHash,
+		PawnHashTable& pawnHashTable)
 	{
 		using namespace scoringConstants;
-		Score score = wBishopStaticVals[move.toSquare] - wBishopStaticVals[move.fromSquare];
-		score += getWhiteBishopSquareCoverScore(board, lookup, move.toSquare);
-		score -= getWhiteBishopSquareCoverScore(board, lookup, move.fromSquare);
-		score += getWhiteMinorPiecePawnProtectedScore(board, lookup, move.toSquare);
-		score -= getWhiteMinorPiecePawnProtectedScore(board, lookup, move.fromSquare);
-		return score;
-	}
 
-	Score getBlackBishopMoveDeltaScore(const BoardState& board, const Move& move,
-		const FastSqLookup& lookup)
-	{
-		using namespace scoringConstants;
-		Score score = -bBishopStaticVals[move.toSquare] + bBishopStaticVals[move.fromSquare];
-		score += getBlackBishopSquareCoverScore(board, lookup, move.toSquare);
-		score -= getBlackBishopSquareCoverScore(board, lookup, move.fromSquare);
-		score += getBlackMinorPiecePawnProtectedScore(board, lookup, move.toSquare);
-		score -= getBlackMinorPiecePawnProtectedScore(board, lookup, move.fromSquare);
-		return score;
-	}
+		const PawnHashTable::Element pawnElem = getPawnElement(bbs, pawnHash, pawnHashTable);
+		Score score = pawnElem.score;
 
-	Score getWhiteRookMoveDeltaScore(const BoardState& board, const Move& move,
-		const BoardEvaluator::PreMoveInfo& preMoveInfo, const FastSqLookup& lookup)
-	{
-		using namespace scoringConstants;
-		Score score = rookStaticVals[move.toSquare] - rookStaticVals[move.fromSquare];
-
-		// Handle change in open file score.
-		const File newFile = files::toFile(move.toSquare);
-		const File oldFile = files::toFile(move.fromSquare);
-		if (!preMoveInfo.movingSidePawnsFileOccupation[newFile])
+		// Give score for rook on open file.
+		for (Bitboard bb = bbs[pieces::wR]; bb != bitboards::empty;)
 		{
-			score += scoringConstants::rookOpenFileVal;
+			if ((pawnElem.whiteFiles & (1 << files::toFile(bitboards::popLsb(bb)))) == 0)
+			{
+				score += rookOpenFileVal;
+			}
 		}
 
-		if (!preMoveInfo.movingSidePawnsFileOccupation[oldFile])
+		for (Bitboard bb = bbs[pieces::bR]; bb != bitboards::empty;)
 		{
-			score -= scoringConstants::rookOpenFileVal;
+			if ((pawnElem.blackFiles & (1 << files::toFile(bitboards::popLsb(bb)))) == 0)
+			{
+				score -= rookOpenFileVal;
+			}
 		}
 
 		return score;
 	}
 
-	Score getBlackRookMoveDeltaScore(const BoardState& board, const Move& move,
-		const BoardEvaluator::PreMoveInfo& preMoveInfo, const FastSqLookup& lookup)
+	// The bishop cover and pawn protection score of a single minor piece. Zero for other pieces.
+	Score getMinorPieceScore(const PieceBitboards& bbs, Piece piece, Square sq)
 	{
-		using namespace scoringConstants;
-		Score score = -rookStaticVals[move.toSquare] + rookStaticVals[move.fromSquare];
-
-		// Handle change in open file score.
-		const File newFile = files::toFile(move.toSquare);
-		const File oldFile = files::toFile(move.fromSquare);
-		if (!preMoveInfo.movingSidePawnsFileOccupation[newFile])
+		const Bitboard pawns = bbs[pieces::wP] | bbs[pieces::bP];
+		switch (piece)
 		{
-			score -= scoringConstants::rookOpenFileVal;
+			case pieces::wN:
+				return getWhiteMinorPiecePawnProtectedScore(bbs, sq);
+			case pieces::bN:
+				return getBlackMinorPiecePawnProtectedScore(bbs, sq);
+			case pieces::wB:
+				return getBishopSquareCoverVal(pawns, sq) +
+					getWhiteMinorPiecePawnProtectedScore(bbs, sq);
+			case pieces::bB:
+				return -getBishopSquareCoverVal(pawns, sq) +
+					getBlackMinorPiecePawnProtectedScore(bbs, sq);
+			default:
+				return 0;
 		}
+	}
 
-		if (!preMoveInfo.movingSidePawnsFileOccupation[oldFile])
+	// Bishop cover and minor pieces protected by pawns.
+	Score getMinorPiecesScore(const PieceBitboards& bbs)
+	{
+		Score score = 0;
+		for (const Piece piece : {pieces::wN, pieces::bN, pieces::wB, pieces::bB})
 		{
-			score += scoringConstants::rookOpenFileVal;
+			for (Bitboard bb = bbs[piece]; bb != bitboards::empty;)
+			{
+				score += getMinorPieceScore(bbs, piece, bitboards::popLsb(bb));
+			}
 		}
 
 		return score;
 	}
 
-	Score getPieceMoveDeltaScore(const BoardState& board, const Move& move,
-		const BoardEvaluator::PreMoveInfo& preMoveInfo, const FastSqLookup& lookup)
+	Score getKingsScore(const PieceBitboards& bbs)
 	{
-		using namespace scoringConstants;
-		assert(BoardEvaluator::canUseGetStaticEvaluationDelta(move));
+		return getWhiteKingScore(bbs, getNumBlackMajorPieces(bbs)) +
+			getBlackKingScore(bbs, getNumWhiteMajorPieces(bbs));
+	}
 
-		switch (move.movingPiece)
-		{
-		case pieces::wN:
-			return getWhiteKnightMoveDeltaScore(board, move, lookup);
-		case pieces::bN:
-			return getBlackKnightMoveDeltaScore(board, move, lookup);
-		case pieces::wB:
-			return getWhiteBishopMoveDeltaScore(board, move, lookup);
-		case pieces::bB:
-			return getBlackBishopMoveDeltaScore(board, move, lookup);
-		case pieces::wR:
-			return getWhiteRookMoveDeltaScore(board, move, preMoveInfo, lookup);
-		case pieces::bR:
-			return getBlackRookMoveDeltaScore(board, move, preMoveInfo, lookup);
-		case pieces::wQ:
-			return wQueenStaticVals[move.toSquare] - wQueenStaticVals[move.fromSquare];
-		case pieces::bQ:
-			return -bQueenStaticVals[move.toSquare] + bQueenStaticVals[move.fromSquare];
-		default:
-			EngineUtilities::logE("Piece passed to getPieceMoveDeltaScore that cannot be used.");
-			return 0;
-		}
+	void movePiece(PieceBitboards& bbs, Piece piece, Square from, Square to)
+	{
+		bbs[piece] ^= bitboards::toBitboard(from) | bitboards::toBitboard(to);
 	}
 }
 
-Score BoardEvaluator::getStaticEvaluation(const BoardState& board, const FastSqLookup& lookup)
+Score BoardEvaluator::getStaticEvaluation(const BoardState& board, PawnHashTable& pawnHashTable)
 {
-	using namespace scoringConstants;
+	const PieceBitboards& bbs = board.getPieceBitboards();
+	const Score score = board.getPieceSquareScore() +
+		getPawnStructureScore(bbs, board.getPawnHash(), pawnHashTable) +
+		getMinorPiecesScore(bbs) + getKingsScore(bbs);
 
-	Score score = 0;
-	int8_t numWhiteMajorPieces = 0;
-	int8_t numBlackMajorPieces = 0;
-
-	// Theoretical max number of rooks is 10.
-	static std::array<Square, 10> wRooks;
-	static std::array<Square, 10> bRooks;
-	int8_t wRookCnt = 0;
-	int8_t bRookCnt = 0;
+	// Negate the score for black, so that a high score is always "good" for both sides.
+	// This makes negaMax style recursive functions possible.
+	return board.getTurn() == pieces::Color::WHITE ? score : -score;
+}
 
-	std::array<bool, files::num> filesOccupiedBybP = { false };
-	std::array<bool, files::num> filesOccupiedBywP = { false };
-	
-	for (Square sq = squares::a1; sq < squares::num; sq++)
-	{
-		assert(EngineUtilities::isValidPiece(board.getPiece(sq)));
-		assert(EngineUtilities::isNonNoneSquare(sq));
+Score BoardEvaluator::getStaticEvaluationDelta(const BoardState& board, const Move& move,
+	const PreMoveInfo& preMoveInfo, PawnHashTable& pawnHashTable)
+{
+	using namespace scoringConstants;
 
-		switch (board.getPiece(sq))
-		{
-			case pieces::wP:
-			{
-				score += wPawnStaticVals[sq];
-				const File f = files::toFile(sq);
-				if (filesOccupiedBywP[f])
-				{
-					score -= doublePawnsPunishmentVal;
-				}
-				else
-				{
-					filesOccupiedBywP[f] = true;
-				}
-			}
-				break;
-			case pieces::wN:
-				numWhiteMajorPieces++;
-				score += wKnightStaticVals[sq];
-				score += getWhiteMinorPiecePawnProtectedScore(board, lookup, sq);
-				break;
-			case pieces::wB:
-				numWhiteMajorPieces++;
-				score += wBishopStaticVals[sq];
-				score += getWhiteBishopSquareCoverScore(board, lookup, sq);
-				score += getWhiteMinorPiecePawnProtectedScore(board, lookup, sq);
-				break;
-			case pieces::wR:
-				numWhiteMajorPieces++;
-				wRooks[wRookCnt++] = sq;
-				score += rookStaticVals[sq];
-				break;
-			case pieces::wQ:
-				numWhiteMajorPieces++;
-				score += wQueenStaticVals[sq];
-				break;
-			case pieces::wK:
-				// King scores are handled elsewhere.
-				break;
-			case pieces::bP:
-			{
-				score -= bPawnStaticVals[sq];
-				const File f = files::toFile(sq);
-				if (filesOccupiedBybP[f])
-				{
-					score += scoringConstants::doublePawnsPunishmentVal;
-				}
-				else
-				{
-					filesOccupiedBybP[f] = true;
-				}
-			}
-				break;
-			case pieces::bN:
-				numBlackMajorPieces++;
-				score -= bKnightStaticVals[sq];
-				score += getBlackMinorPiecePawnProtectedScore(board, lookup, sq);
-				break;
-			case pieces::bB:
-				numBlackMajorPieces++;
-				score -= bBishopStaticVals[sq];
-				score += getBlackBishopSquareCoverScore(board, lookup, sq);
-				score += getBlackMinorPiecePawnProtectedScore(board, lookup, sq);
-				break;
-			case pieces::bR:
-				bRooks[bRookCnt++] = sq;
-				numBlackMajorPieces++;
-				score -= rookStaticVals[sq];
-				break;
-			case pieces::bQ:
-				numBlackMajorPieces++;
-				score -= bQueenStaticVals[sq];
-				break;
-			case pieces::bK:
-				// King scores are handled elsewhere.
-				break;
-		}
+	const Square from = move.getFromSquare();
+	const Square to = move.getToSquare();
+	const Piece movingPiece = board.getPiece(from);
+	assert(EngineUtilities::isNonNonePiece(movingPiece));
+	const Piece placedPiece = move.isPromotion() ? move.getPromotionPiece(board.getTurn()) :
+		movingPiece;
+
+	// Apply the move to a copy of the bitboards, and keep track of which pieces it touched.
+	PieceBitboards bbs = board.getPieceBitboards();
+	bbs[movingPiece] &= ~bitboards::toBitboard(from);
+	bbs[placedPiece] |= bitboards::toBitboard(to);
+	Score score = pieceSquareScores[placedPiece][to] - pieceSquareScores[movingPiece][from];
+	uint16_t touchedPieces = toPieceMask(movingPiece) | toPieceMask(placedPiece);
+	const Hash64 prePawnHash = board.getPawnHash();
+	Hash64 pawnHash = prePawnHash ^ getPawnHashValue(movingPiece, from) ^
+		getPawnHashValue(placedPiece, to);
+
+	if (move.isCapture())
+	{
+		const Square capturedSquare = !move.isEnPassantCapture() ? to :
+			board.getTurn() == pieces::Color::WHITE ? to - 8 : to + 8;
+		const Piece capturedPiece = board.getPiece(capturedSquare);
+		assert(EngineUtilities::isNonNonePiece(capturedPiece));
+		bbs[capturedPiece] &= ~bitboards::toBitboard(capturedSquare);
+		score -= pieceSquareScores[capturedPiece][capturedSquare];
+		touchedPieces |= toPieceMask(capturedPiece);
+		pawnHash ^= getPawnHashValue(capturedPiece, capturedSquare);
 	}
 
-	// Handle king scores.
-	score += getWhiteKingScore(board, numBlackMajorPieces);
-	score += getBlackKingScore(board, numWhiteMajorPieces);
+	if (move.isCastling())
+	{
+		const auto [rookFrom, rookTo] = BoardState::getCastlingRookSquares(to);
+		const Piece rook = board.getPiece(rookFrom);
+		movePiece(bbs, rook, rookFrom, rookTo);
+		score += pieceSquareScores[rook][rookTo] - pieceSquareScores[rook][rookFrom];
+		touchedPieces |= toPieceMask(rook);
+	}
 
-	// Give score for rook on open file.
-	for (int8_t i = 0; i < wRookCnt; i++)
+	// Only recompute the terms that the move can change.
+	if ((touchedPieces & pawnStructureDependencies) != 0)
 	{
-		if (!filesOccupiedBywP[files::toFile(wRooks[i])])
-		{
-			score += scoringConstants::rookOpenFileVal;
-		}
+		score += getPawnStructureScore(bbs, pawnHash, pawnHashTable) -
+			preMoveInfo.pawnStructureScore;
 	}
 
-	for (int8_t i = 0; i < bRookCnt; i++)
+	if ((touchedPieces & pawnsMask) != 0)
 	{
-		if (!filesOccupiedBybP[files::toFile(bRooks[i])])
+		score += getMinorPiecesScore(bbs) - preMoveInfo.minorPiecesScore;
+	}
+	else if ((touchedPieces & minorPiecesMask) != 0)
+	{
+		// With the pawns where they were, only the minor pieces that moved or were captured change.
+		const PieceBitboards& preMoveBbs = board.getPieceBitboards();
+		score += getMinorPieceScore(bbs, placedPiece, to) -
+			getMinorPieceScore(preMoveBbs, movingPiece, from);
+		if (move.isCapture())
 		{
-			score -= scoringConstants::rookOpenFileVal;
+			score -= getMinorPieceScore(preMoveBbs, board.getPiece(to), to);
 		}
 	}
 
-	// Punish pawn islands.
-	score -= getPawnIslandsVal(filesOccupiedBywP, scoringConstants::pawnIslandPunishmentVal);
-	score += getPawnIslandsVal(filesOccupiedBybP, scoringConstants::pawnIslandPunishmentVal);
-
-	// Negate the score for black, so that a high score is always "good" for both sides.
-	// This makes negaMax style recursive functions possible.
-	return board.getTurn() == pieces::Color::WHITE ? score : -score;
-}
-
-Score BoardEvaluator::getStaticEvaluationDelta(const BoardState& board, const Move& move,
-	const PreMoveInfo& preMoveInfo, const FastSqLookup& lookup)
-{
-assert(canUseGetStaticEvaluationDelta(move));
-
-	const Score delta = getPieceMoveDeltaScore(board, move, preMoveInfo, lookup);
-	return board.getTurn() == pieces::Color::WHITE ? delta : -delta;
-}
-
-bool BoardEvaluator::canUseGetStaticEvaluationDelta(const Move& move)
-{
-	assert(EngineUtilities::isNonNonePiece(move.movingPiece));
-
-	if (move.capturedPiece != pieces::none)
+	if ((touchedPieces & kingsDependencies) != 0 || move.isCapture() || move.isPromotion())
 	{
-		return false;
+		score += getKingsScore(bbs) - preMoveInfo.kingsScore;
 	}
 
-	return isNonPawnNonKing(move.movingPiece);
+	return board.getTurn() == pieces::Color::WHITE ? score : -score;
 }
 
-BoardEvaluator::PreMoveInfo BoardEvaluator::createPreMoveInfo(const BoardState& board)
+BoardEvaluator::PreMoveInfo BoardEvaluator::createPreMoveInfo(const BoardState& board,
+	PawnHashTable& pawnHashTable)
 {
-	const Piece movingSidePawn = board.getTurn() == pieces::Color::WHITE ? pieces::wP : pieces::bP;
-	return createFromMovingSidePawn(board, movingSidePawn);
+	const PieceBitboards& bbs = board.getPieceBitboards();
+	PreMoveInfo info;
+	info.pawnStructureScore = getPawnStructureScore(bbs, board.getPawnHash(), pawnHashTable);
+	info.minorPiecesScore = getMinorPiecesScore(bbs);
+	info.kingsScore = getKingsScore(bbs);
+	return info;
 }
 
 Score BoardEvaluator::getPawnBaseValue()
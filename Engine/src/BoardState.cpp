@@ -2,6 +2,7 @@
 
 #include "PrivateInclude/EngineUtilities.h"
 #include "PrivateInclude/Move.h"
+#include "PrivateInclude/ScoringConstants.h"
 #include "Common/CommonUtilities.h"
 
 #include <iostream>
@@ -10,8 +11,6 @@
 
 namespace
 {
-	static constexpr Hash64 transpositionTableMaxLength = 5000000;
-
 	std::optional<Square> fromString(const std::string& str)
 	{
 		if (str == "-")
@@ -163,7 +162,7 @@ namespace
 		return *eSq;
 	}
 
-	std::optional<std::unordered_map<char, bool>> getCastleAvailabilityFromFEN(const std::string& str)
+	std::optional<CastlingRights> getCastlingRightsFromFEN(const std::string& str)
 	{
 		if (str.size() < 1)
 		{
@@ -171,11 +170,10 @@ namespace
 			return {};
 		}
 
-
-		std::unordered_map<char, bool> castle{{'K', false}, { 'Q', false }, { 'k', false }, { 'q', false }};
+		CastlingRights rights = castlingRights::none;
 		if (str[0] == '-')
 		{
-			return castle;
+			return rights;
 		}
 
 		for (const char c : str)
@@ -183,16 +181,16 @@ namespace
 			switch (c)
 			{
 				case 'Q':
-					castle[c] = true;
+					rights |= castlingRights::wQueenSide;
 					break;
 				case 'K':
-					castle[c] = true;
+					rights |= castlingRights::wKingSide;
 					break;
 				case 'q':
-					castle[c] = true;
+					rights |= castlingRights::bQueenSide;
 					break;
 				case 'k':
-					castle[c] = true;
+					rights |= castlingRights::bKingSide;
 					break;
 				default:
 					EngineUtilities::logE("Invalid char in castling availability in FEN: " + c);
@@ -200,9 +198,32 @@ namespace
 			}
 		}
 
-		return castle;
+		return rights;
 	}
 
+	// The castling rights that are kept when a piece moves from or to each square. A king or a
+	// rook leaving its start square, or a rook being captured on it, removes the rights.
+	constexpr std::array<CastlingRights, squares::num> createCastlingRightsKeptMasks()
+	{
+		using namespace castlingRights;
+		std::array<CastlingRights, squares::num> masks = {0};
+		for (size_t sq = 0; sq < squares::num; sq++)
+		{
+			masks[sq] = all;
+		}
+
+		masks[squares::e1] = all & ~(wKingSide | wQueenSide);
+		masks[squares::h1] = all & ~wKingSide;
+		masks[squares::a1] = all & ~wQueenSide;
+		masks[squares::e8] = all & ~(bKingSide | bQueenSide);
+		masks[squares::h8] = all & ~bKingSide;
+		masks[squares::a8] = all & ~bQueenSide;
+		return masks;
+	}
+
+	static constexpr std::array<CastlingRights, squares::num> castlingRightsKeptMasks =
+		createCastlingRightsKeptMasks();
+
 	Square findWhiteKingSquare(const BoardState& board)
 	{
 		const auto& pieces = board.getPieces();
@@ -318,30 +339,30 @@ namespace
 	bool isCastlinAvailabilityValid(const BoardState& board)
 	{
 		using namespace pieces;
-		const auto& cas = board.getCastleAvailability();
+		const CastlingRights cas = board.getCastlingRights();
 		const auto& psc = board.getPieces();
-		if (cas.find('K')->second)
+		if (cas & castlingRights::wKingSide)
 		{
 			if (psc[squares::e1] != wK || psc[squares::h1] != wR)
 			{
 				return false;
 			}
 		}
-		if (cas.find('Q')->second)
+		if (cas & castlingRights::wQueenSide)
 		{
 			if (psc[squares::e1] != wK || psc[squares::a1] != wR)
 			{
 				return false;
 			}
 		}
-		if (cas.find('k')->second)
+		if (cas & castlingRights::bKingSide)
 		{
 			if (psc[squares::e8] != bK || psc[squares::h8] != bR)
 			{
 				return false;
 			}
 		}
-		if (cas.find('q')->second)
+		if (cas & castlingRights::bQueenSide)
 		{
 			if (psc[squares::e8] != bK || psc[squares::a8] != bR)
 			{
@@ -360,24 +381,42 @@ namespace
 			board.getPiece(wKsq) == pieces::wK && board.getPiece(bKsq) == pieces::bK;
 	}
 
-	int16_t getHashIndex(Square sq, Piece piece)
+	bool areBitboardsValid(const BoardState& board)
 	{
-		return sq * pieces::num + piece;
+		Bitboard white = bitboards::empty;
+		Bitboard black = bitboards::empty;
+		for (Square sq = squares::a1; sq < squares::num; sq++)
+		{
+			const Piece piece = board.getPiece(sq);
+			for (Piece p = 0; p < pieces::num; p++)
+			{
+				const bool isSet = (board.getPieceBitboard(p) & bitboards::toBitboard(sq)) != 0;
+				if (isSet != (p == piece))
+				{
+					return false;
+				}
+			}
+
+			if (EngineUtilities::isWhite(piece)) { white |= bitboards::toBitboard(sq); }
+			else if (EngineUtilities::isBlack(piece)) { black |= bitboards::toBitboard(sq); }
+		}
+
+		return white == board.getColorBitboard(pieces::Color::WHITE) &&
+			black == board.getColorBitboard(pieces::Color::BLACK);
 	}
-}
 
-BoardState::BoardState(bool reserveTranspositionTable)
-{
-#ifdef NDEBUG
-	transpositionTable.reserve(transpositionTableMaxLength);
-#endif
+	size_t getColorIndex(Piece piece)
+	{
+		assert(EngineUtilities::isNonNonePiece(piece));
+		return static_cast<size_t>(piece < pieces::bK ? pieces::Color::WHITE : pieces::Color::BLACK);
+	}
 }
 
 bool BoardState::operator==(const BoardState& other) const
 {
 #ifndef NDEBUG
 	// Debug build.
-	return (pieces == other.getPieces() && casleAvailability == other.getCastleAvailability() &&
+	return (pieces == other.getPieces() && castlingRights == other.getCastlingRights() &&
 		enPassantSquare == other.getEnPassantSquare() && turn == other.getTurn() &&
 		hash == other.getHash());
 #else
@@ -417,9 +456,9 @@ bool BoardState::initFromFEN(const std::string& FEN)
 	}
 
 	// Set castling availability.
-	if (const auto castle = getCastleAvailabilityFromFEN(splitFEN[2]))
+	if (const auto castle = getCastlingRightsFromFEN(splitFEN[2]))
 	{
-		casleAvailability = *castle;
+		castlingRights = *castle;
 	}
 	else
 	{
@@ -436,6 +475,8 @@ bool BoardState::initFromFEN(const std::string& FEN)
 		return false;
 	}
 
+	initBitboards();
+
 	// Set king squares.
 	wKingSq = findWhiteKingSquare(*this);
 	bKingSq = findBlackKingSquare(*this);
@@ -446,8 +487,10 @@ bool BoardState::initFromFEN(const std::string& FEN)
 		return false;
 	}
 
-	// Update the hash according to this board state.
+	// Update the hash and the score according to this board state.
 	hash = generateHash();
+	pawnHash = generatePawnHash();
+	pieceSquareScore = generatePieceSquareScore();
 
 	return true;
 }
@@ -497,20 +540,11 @@ std::string BoardState::toFEN() const
 	FEN += " ";
 
 	// Castling availability.
-	bool noCastling = true;
-	for (const auto entry : casleAvailability)
-	{
-		if (entry.second)
-		{
-			FEN += entry.first;
-			noCastling = false;
-		}
-	}
-
-	if (noCastling)
-	{
-		FEN += "-";
-	}
+	if (castlingRights & castlingRights::wKingSide) FEN += "K";
+	if (castlingRights & castlingRights::wQueenSide) FEN += "Q";
+	if (castlingRights & castlingRights::bKingSide) FEN += "k";
+	if (castlingRights & castlingRights::bQueenSide) FEN += "q";
+	if (castlingRights == castlingRights::none) FEN += "-";
 
 	FEN += " ";
 
@@ -542,132 +576,133 @@ void BoardState::makeMove(const Move& move)
 	using namespace pieces;
 	using namespace hashValues;
 
-	// Handle castling availability.
-	if (move.prohibitsWKcastling)
-	{
-		assert(casleAvailability['K']);
-		casleAvailability['K'] = false;
-		hash ^= values[castlingIndexStart];
-	}
-	if (move.prohibitsWQcastling)
+	const Square from = move.getFromSquare();
+	const Square to = move.getToSquare();
+	const Piece movingPiece = pieces[from];
+	assert(EngineUtilities::isNonNonePiece(movingPiece));
+
+	assert(undoStackSize < undoStack.size());
+	UndoInfo& undo = undoStack[undoStackSize++];
+	undo.hash = hash;
+	undo.capturedPiece = none;
+	undo.enPassantSquare = enPassantSquare;
+
+	undo.castlingRights = castlingRights;
+
+	// Castling rights are lost when a king or rook leaves its start square, or a rook is captured.
+	const CastlingRights newCastlingRights =
+		castlingRights & castlingRightsKeptMasks[from] & castlingRightsKeptMasks[to];
+	hash ^= castlingValues[castlingRights ^ newCastlingRights];
+	castlingRights = newCastlingRights;
+
+	// Any move removes the previous en passant square.
+	if (enPassantSquare != squares::none)
 	{
-		assert(casleAvailability['Q']);
-		casleAvailability['Q'] = false;
-		hash ^= values[castlingIndexStart + 1];
+		hash ^= values[(size_t)enPassantSqIndexStart + enPassantSquare];
+		enPassantSquare = squares::none;
 	}
-	if (move.prohibitsBKcastling)
+
+	if (move.isCapture())
 	{
-		assert(casleAvailability['k']);
-		casleAvailability['k'] = false;
-		hash ^= values[castlingIndexStart + 2];
+		const Square capturedSquare = !move.isEnPassantCapture() ? to :
+			turn == Color::WHITE ? to - 8 : to + 8;
+		undo.capturedPiece = pieces[capturedSquare];
+		clearSquare(capturedSquare);
+		hash ^= values[getHashIndex(capturedSquare, undo.capturedPiece)];
 	}
-	if (move.prohibitsBQcastling)
+
+	clearSquare(from);
+	hash ^= values[getHashIndex(from, movingPiece)];
+	const Piece placedPiece = move.isPromotion() ? move.getPromotionPiece(turn) : movingPiece;
+	placePiece(to, placedPiece);
+	hash ^= values[getHashIndex(to, placedPiece)];
+
+	if (movingPiece == wK)
 	{
-		assert(casleAvailability['q']);
-		casleAvailability['q'] = false;
-		hash ^= values[castlingIndexStart + 3];
+		wKingSq = to;
 	}
-
-	// Must be set for all moves since any move will remove previous en passant square.
-	enPassantSquare = move.enPassantCreatedSquare;
-	if (move.previousEnPassantSquare != squares::none)
+	else if (movingPiece == bK)
 	{
-		hash ^= values[(size_t)enPassantSqIndexStart + move.previousEnPassantSquare];
+		bKingSq = to;
 	}
 
-	if (move.enPassantCreatedSquare != squares::none)
+	if (move.isCastling())
 	{
-		hash ^= values[(size_t)enPassantSqIndexStart + move.enPassantCreatedSquare];
+		moveCastlingRook(to, false);
 	}
-
-	switch (move.movingPiece)
+	else if (move.isDoublePawnPush())
 	{
-		case wP:
-		case bP:
-			makePawnMove(move);
-			break;
-		case wK:
-		case bK:
-			makeKingMove(move);
-			break;
-		default:
-			makeNonSpecializedMove(move);
-			break;
+		// One square behind the pawn.
+		enPassantSquare = (from + to) / 2;
+		hash ^= values[(size_t)enPassantSqIndexStart + enPassantSquare];
 	}
 
 	// Finally, switch side to play.
 	turn = turn == Color::WHITE ? Color::BLACK : Color::WHITE;
 	hash ^= values[whiteToPlayIndex];
 	assert(hash == generateHash());
+	assert(pawnHash == generatePawnHash());
+	assert(pieceSquareScore == generatePieceSquareScore());
+
+	// The search will most likely probe the transposition table for this position next.
+	if (transpositionTable != nullptr)
+	{
+		transpositionTable->prefetch(hash);
+	}
 }
 
 void BoardState::unmakeMove(const Move& move)
 {
 	using namespace pieces;
-	using namespace hashValues;
 
-	if (move.prohibitsWKcastling)
-	{
-		assert(!casleAvailability['K']);
-		casleAvailability['K'] = true;
-		hash ^= values[castlingIndexStart];
-	}
-	if (move.prohibitsWQcastling)
-	{
-		assert(!casleAvailability['Q']);
-		casleAvailability['Q'] = true;
-		hash ^= values[castlingIndexStart + 1];
-	}
-	if (move.prohibitsBKcastling)
-	{
-		assert(!casleAvailability['k']);
-		casleAvailability['k'] = true;
-		hash ^= values[castlingIndexStart + 2];
-	}
-	if (move.prohibitsBQcastling)
+	assert(undoStackSize > 0);
+	const UndoInfo& undo = undoStack[--undoStackSize];
+
+	// Switch back to the side that made the move first, the rest depends on it.
+	turn = turn == Color::WHITE ? Color::BLACK : Color::WHITE;
+
+	const Square from = move.getFromSquare();
+	const Square to = move.getToSquare();
+	const Piece placedPiece = pieces[to];
+	const Piece movingPiece = !move.isPromotion() ? placedPiece :
+		turn == Color::WHITE ? wP : bP;
+
+	if (move.isCastling())
 	{
-		assert(!casleAvailability['q']);
-		casleAvailability['q'] = true;
-		hash ^= values[castlingIndexStart + 3];
+		moveCastlingRook(to, true);
 	}
 
-	// Must be set for all moves since any move will remove previous en passant square.
-	enPassantSquare = move.previousEnPassantSquare;
-	if (move.enPassantCreatedSquare != squares::none)
+	clearSquare(to);
+	placePiece(from, movingPiece);
+
+	if (movingPiece == wK)
 	{
-		hash ^= values[(size_t)enPassantSqIndexStart + move.enPassantCreatedSquare];
+		wKingSq = from;
 	}
-
-	if (move.previousEnPassantSquare != squares::none)
+	else if (movingPiece == bK)
 	{
-		hash ^= values[(size_t)enPassantSqIndexStart + move.previousEnPassantSquare];
+		bKingSq = from;
 	}
 
-	switch (move.movingPiece)
+	if (move.isCapture())
 	{
-		case wP:
-		case bP:
-			unmakePawnMove(move);
-			break;
-		case wK:
-		case bK:
-			unmakeKingMove(move);
-			break;
-		default:
-			unmakeNonSpecializedMove(move);
-			break;
+		const Square capturedSquare = !move.isEnPassantCapture() ? to :
+			turn == Color::WHITE ? to - 8 : to + 8;
+		placePiece(capturedSquare, undo.capturedPiece);
 	}
 
-	//Finally, switch side to play.
-	turn = turn == Color::WHITE ? Color::BLACK : Color::WHITE;
-	hash ^= values[whiteToPlayIndex];
+	enPassantSquare = undo.enPassantSquare;
+	castlingRights = undo.castlingRights;
+	hash = undo.hash;
 	assert(hash == generateHash());
+	assert(pawnHash == generatePawnHash());
+	assert(pieceSquareScore == generatePieceSquareScore());
 }
 
 bool BoardState::isValid() const
 {
 	return isPieceCountValid(*this) && isEnPassantSqValid(*this) &&
-		isCastlinAvailabilityValid(*this) && isKingSquaresValid(*this);
+		isCastlinAvailabilityValid(*this) && isKingSquaresValid(*this) && areBitboardsValid(*this);
 }
 
 Hash64 BoardState::generateHash() const
@@ -676,12 +711,11 @@ Hash64 BoardState::generateHash() const
 	Hash64 hash = 0;
 
 	// Hash pieces on the board.
-	for (Square sq = 0; sq < squares::num; sq++)
+	for (Piece piece = pieces::wK; piece < pieces::num; piece++)
 	{
-		assert(EngineUtilities::isValidSquare(sq));
-		if (pieces[sq] != pieces::none)
+		for (Bitboard bb = pieceBitboards[piece]; bb != bitboards::empty;)
 		{
-			hash ^= values[getHashIndex(sq, pieces[sq])];
+			hash ^= values[getHashIndex(bitboards::popLsb(bb), piece)];
 		}
 	}
 
@@ -692,10 +726,7 @@ Hash64 BoardState::generateHash() const
 	}
 
 	// Hash castling possible.
-	if (casleAvailability.find('K')->second) hash ^= values[castlingIndexStart];
-	if (casleAvailability.find('Q')->second) hash ^= values[castlingIndexStart + 1];
-	if (casleAvailability.find('k')->second) hash ^= values[castlingIndexStart + 2];
-	if (casleAvailability.find('q')->second) hash ^= values[castlingIndexStart + 3];
+	hash ^= castlingValues[castlingRights];
 
 	// Hash en passant square.
 	if (enPassantSquare != squares::none)
@@ -706,248 +737,119 @@ Hash64 BoardState::generateHash() const
 	return hash;
 }
 
-void BoardState::addTranspositionElement(const searchHelpers::tp::Element& elem)
-{
-	if (transpositionTable.size() >= transpositionTableMaxLength)
-	{
-		return;
-	}
-
-	transpositionTable[hash] = elem;
-}
-
-const searchHelpers::tp::Element* BoardState::findTranspositionElement() const
-{
-	const auto it = transpositionTable.find(hash);
-	if (it == transpositionTable.end())
-	{
-		return nullptr;
-	}
-
-	return &it->second;
-}
-
-void BoardState::makePawnMove(const Move& move)
+Hash64 BoardState::generatePawnHash() const
 {
 	using namespace hashValues;
-
-	if (move.pawnPromotionPiece != pieces::none)
+	Hash64 hash = 0;
+	for (const Piece pawn : {pieces::wP, pieces::bP})
 	{
-		pieces[move.fromSquare] = pieces::none;
-		hash ^= values[getHashIndex(move.fromSquare, move.movingPiece)];
-		if (move.capturedPiece != pieces::none)
+		for (Bitboard bb = pieceBitboards[pawn]; bb != bitboards::empty;)
 		{
-			pieces[move.capturedSquare] = pieces::none;
-			hash ^= values[getHashIndex(move.capturedSquare, move.capturedPiece)];
+			hash ^= values[getHashIndex(bitboards::popLsb(bb), pawn)];
 		}
-
-		pieces[move.toSquare] = move.pawnPromotionPiece;
-		hash ^= values[getHashIndex(move.toSquare, move.pawnPromotionPiece)];
-	}
-	else
-	{
-		makeNonSpecializedMove(move);
 	}
+
+	return hash;
 }
 
-void BoardState::unmakePawnMove(const Move& move)
+Score BoardState::generatePieceSquareScore() const
 {
-	using namespace hashValues;
-
-	// In case of pawn promotion, the hashing must be handled specifically.
-	if (move.pawnPromotionPiece != pieces::none)
+	Score score = 0;
+	for (Piece piece = pieces::wK; piece < pieces::num; piece++)
 	{
-		hash ^= values[getHashIndex(move.toSquare, move.pawnPromotionPiece)];
-		if (move.capturedPiece != pieces::none)
+		for (Bitboard bb = pieceBitboards[piece]; bb != bitboards::empty;)
 		{
-			hash ^= values[getHashIndex(move.capturedSquare, move.capturedPiece)];
+			score += scoringConstants::pieceSquareScores[piece][bitboards::popLsb(bb)];
 		}
-		hash ^= values[getHashIndex(move.fromSquare, move.movingPiece)];
-
-		unmakeNonSpecializedMove(move, false);
 	}
-	else
-	{
-		unmakeNonSpecializedMove(move);
-	}
-}
 
-void BoardState::makeKingMove(const Move& move)
-{
-	if (turn == pieces::Color::WHITE)
-	{
-		wKingSq = move.toSquare;
-		makeWhiteRookMoveIfCastling(move);
-	}
-	else
-	{
-		bKingSq = move.toSquare;
-		makeBlackRookMoveIfCastling(move);
-	}
-
-	makeNonSpecializedMove(move);
+	return score;
 }
 
-void BoardState::unmakeKingMove(const Move& move)
+bool BoardState::addTranspositionElement(const searchHelpers::tp::Element& elem)
 {
-	// At this point turn has switched sides, therefore the color check may seem wrong but is correct.
-	if (turn == pieces::Color::BLACK)
-	{
-		wKingSq = move.fromSquare;
-		unmakeWhiteRookMoveIfCastling(move);
-	}
-	else
-	{
-		bKingSq = move.fromSquare;
-		unmakeBlackRookMoveIfCastling(move);
-	}
-
-	unmakeNonSpecializedMove(move);
+	assert(transpositionTable != nullptr);
+	return transpositionTable->store(hash, elem);
 }
 
-void BoardState::makeWhiteRookMoveIfCastling(const Move& move)
+std::optional<searchHelpers::tp::Element> BoardState::findTranspositionElement() const
 {
-	using namespace hashValues;
-	assert(move.movingPiece == pieces::wK);
-
-	// Perform casteling (rook only).
-	if (move.fromSquare == squares::e1)
-	{
-		if (move.toSquare == squares::g1)
-		{
-			assert(pieces[squares::h1] == pieces::wR);
-			pieces[squares::h1] = pieces::none;
-			pieces[squares::f1] = pieces::wR;
-			hash ^= values[getHashIndex(squares::h1, pieces::wR)];
-			hash ^= values[getHashIndex(squares::f1, pieces::wR)];
-		}
-		else if (move.toSquare == squares::c1)
-		{
-			assert(pieces[squares::a1] == pieces::wR);
-			pieces[squares::a1] = pieces::none;
-			pieces[squares::d1] = pieces::wR;
-			hash ^= values[getHashIndex(squares::a1, pieces::wR)];
-			hash ^= values[getHashIndex(squares::d1, pieces::wR)];
-		}
-	}
+	assert(transpositionTable != nullptr);
+	return transpositionTable->find(hash);
 }
 
-void BoardState::makeBlackRookMoveIfCastling(const Move& move)
+std::pair<Square, Square> BoardState::getCastlingRookSquares(Square kingToSquare)
 {
-	using namespace hashValues;
-	assert(move.movingPiece == pieces::bK);
-
-	// Perform casteling (rook only).
-	if (move.fromSquare == squares::e8)
+	switch (kingToSquare)
 	{
-		if (move.toSquare == squares::g8)
-		{
-			assert(pieces[squares::h8] == pieces::bR);
-			pieces[squares::h8] = pieces::none;
-			pieces[squares::f8] = pieces::bR;
-			hash ^= values[getHashIndex(squares::h8, pieces::bR)];
-			hash ^= values[getHashIndex(squares::f8, pieces::bR)];
-		}
-		else if (move.toSquare == squares::c8)
-		{
-			assert(pieces[squares::a8] == pieces::bR);
-			pieces[squares::a8] = pieces::none;
-			pieces[squares::d8] = pieces::bR;
-			hash ^= values[getHashIndex(squares::a8, pieces::bR)];
-			hash ^= values[getHashIndex(squares::d8, pieces::bR)];
-		}
+		case squares::g1: return {squares::h1, squares::f1};
+		case squares::c1: return {squares::a1, squares::d1};
+		case squares::g8: return {squares::h8, squares::f8};
+		case squares::c8: return {squares::a8, squares::d8};
+		default:
+			assert(false && "Invalid castling move.");
+			return {squares::none, squares::none};
 	}
 }
 
-void BoardState::unmakeWhiteRookMoveIfCastling(const Move& move)
+void BoardState::moveCastlingRook(Square kingToSquare, bool undo)
 {
 	using namespace hashValues;
-	assert(move.movingPiece == pieces::wK);
 
-	// Unmake casteling (rook only).
-	if (move.fromSquare == squares::e1)
+	auto [rookFrom, rookTo] = getCastlingRookSquares(kingToSquare);
+	if (undo)
 	{
-		if (move.toSquare == squares::g1)
-		{
-			assert(pieces[squares::h1] == pieces::none);
-			pieces[squares::h1] = pieces::wR;
-			pieces[squares::f1] = pieces::none;
-			hash ^= values[getHashIndex(squares::h1, pieces::wR)];
-			hash ^= values[getHashIndex(squares::f1, pieces::wR)];
-		}
-		else if (move.toSquare == squares::c1)
-		{
-			assert(pieces[squares::a1] == pieces::none);
-			pieces[squares::a1] = pieces::wR;
-			pieces[squares::d1] = pieces::none;
-			hash ^= values[getHashIndex(squares::a1, pieces::wR)];
-			hash ^= values[getHashIndex(squares::d1, pieces::wR)];
-		}
+		std::swap(rookFrom, rookTo);
 	}
+
+	const Piece rook = pieces[rookFrom];
+	assert(rook == pieces::wR || rook == pieces::bR);
+	clearSquare(rookFrom);
+	placePiece(rookTo, rook);
+	hash ^= values[getHashIndex(rookFrom, rook)];
+	hash ^= values[getHashIndex(rookTo, rook)];
 }
 
-void BoardState::unmakeBlackRookMoveIfCastling(const Move& move)
+void BoardState::placePiece(Square sq, Piece piece)
 {
-	using namespace hashValues;
-	assert(move.movingPiece == pieces::bK);
-
-	// Unmake casteling (rook only).
-	if (move.fromSquare == squares::e8)
+	assert(pieces[sq] == pieces::none);
+	const Bitboard bb = bitboards::toBitboard(sq);
+	pieces[sq] = piece;
+	pieceBitboards[piece] |= bb;
+	colorBitboards[getColorIndex(piece)] |= bb;
+	pieceSquareScore += scoringConstants::pieceSquareScores[piece][sq];
+	if (hashValues::isPawn(piece))
 	{
-		if (move.toSquare == squares::g8)
-		{
-			assert(pieces[squares::h8] == pieces::none);
-			pieces[squares::h8] = pieces::bR;
-			pieces[squares::f8] = pieces::none;
-			hash ^= values[getHashIndex(squares::h8, pieces::bR)];
-			hash ^= values[getHashIndex(squares::f8, pieces::bR)];
-		}
-		else if (move.toSquare == squares::c8)
-		{
-			assert(pieces[squares::a8] == pieces::none);
-			pieces[squares::a8] = pieces::bR;
-			pieces[squares::d8] = pieces::none;
-			hash ^= values[getHashIndex(squares::a8, pieces::bR)];
-			hash ^= values[getHashIndex(squares::d8, pieces::bR)];
-		}
+		pawnHash ^= hashValues::values[hashValues::getHashIndex(sq, piece)];
 	}
 }
 
-void BoardState::makeNonSpecializedMove(const Move& move)
+void BoardState::clearSquare(Square sq)
 {
-	using namespace hashValues;
-
-	pieces[move.fromSquare] = pieces::none;
-	hash ^= values[getHashIndex(move.fromSquare, move.movingPiece)];
-	if (move.capturedPiece != pieces::none)
+	const Piece piece = pieces[sq];
+	assert(EngineUtilities::isNonNonePiece(piece));
+	const Bitboard bb = bitboards::toBitboard(sq);
+	pieces[sq] = pieces::none;
+	pieceBitboards[piece] &= ~bb;
+	colorBitboards[getColorIndex(piece)] &= ~bb;
+	pieceSquareScore -= scoringConstants::pieceSquareScores[piece][sq];
+	if (hashValues::isPawn(piece))
 	{
-		pieces[move.capturedSquare] = pieces::none;
-		hash ^= values[getHashIndex(move.capturedSquare, move.capturedPiece)];
+		pawnHash ^= hashValues::values[hashValues::getHashIndex(sq, piece)];
 	}
-
-	pieces[move.toSquare] = move.movingPiece;
-	hash ^= values[getHashIndex(move.toSquare, move.movingPiece)];
 }
 
-void BoardState::unmakeNonSpecializedMove(const Move& move, bool updateHash)
+void BoardState::initBitboards()
 {
-	using namespace hashValues;
-
-	pieces[move.toSquare] = pieces::none;
-	if (move.capturedPiece != pieces::none)
+	pieceBitboards.fill(bitboards::empty);
+	colorBitboards.fill(bitboards::empty);
+	for (Square sq = squares::a1; sq < squares::num; sq++)
 	{
-		pieces[move.capturedSquare] = move.capturedPiece;
-	}
-	pieces[move.fromSquare] = move.movingPiece;
-
-	if (updateHash)
-	{
-		hash ^= values[getHashIndex(move.toSquare, move.movingPiece)];
-		if (move.capturedPiece != pieces::none)
+		const Piece piece = pieces[sq];
+		if (piece != pieces::none)
 		{
-			hash ^= values[getHashIndex(move.capturedSquare, move.capturedPiece)];
+			pieceBitboards[piece] |= bitboards::toBitboard(sq);
+			colorBitboards[getColorIndex(piece)] |= bitboards::toBitboard(sq);
 		}
-		hash ^= values[getHashIndex(move.fromSquare, move.movingPiece)];
 	}
 }
-
@@ -1,11 +1,16 @@
 #include "PrivateInclude/Engine.h"
 
 #include "PrivateInclude/Move.h"
+#include "PrivateInclude/MoveList.h"
+#include "PrivateInclude/MovePicker.h"
 #include "PrivateInclude/EngineUtilities.h"
 #include "Common/StopWatch.h"
 
 #include <cassert>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <limits>
 
 namespace moveGenerationHelpers
 {
@@ -13,7 +18,8 @@ namespace moveGenerationHelpers
 	enum class TypeFilter
 	{
 		All, // Include ALL moves, both silent and capturing.
-		CaptAndPromot // Include only captures and pawn promotions.
+		CaptAndPromot, // Include only captures and pawn promotions.
+		Quiet // Include only the moves not included by 'CaptAndPromot'.
 	};
 
 	// Use of 'PseudoLegal' is faster than 'StrictlyLegal' since no looking for moving-side check is done.
@@ -23,1056 +29,667 @@ namespace moveGenerationHelpers
 		PseudoLegal // Includes same moves as 'StrictlyLegal', plus those causing moving-side check.
 	};
 
+	// Only used for strictly legal moves, see initLegalityMasks(). The default values let all
+	// moves through, which is what the pseudo-legal moves need.
 	struct Lookup
 	{
-		Lookup(const FastSqLookup& fastSqLookup) : fSqL{fastSqLookup}{}
+		Square kingSq = squares::none;
 
-		const FastSqLookup& fSqL;
-		bool movingSideInCheckPreMove = true;
-		TypeFilter tFilter = TypeFilter::All;
-		LegalityFilter lFilter = LegalityFilter::StrictlyLegal;
+		// The squares that non-king moves must end on. When in check, that is the square of the
+		// checking piece and the squares between it and the king (empty if in double check).
+		Bitboard checkMask = bitboards::all;
+
+		// Pieces of the moving side that can only move along the line through them and the king.
+		Bitboard pinned = bitboards::empty;
 	};
 
+	// The functions below are templated on the color (and the filters), so that the generation of
+	// each color and kind of moves is compiled into code of its own, without any runtime checks of
+	// the color or the filters.
 
-	Piece getPieceAtEndOfSweep(const BoardState& board, const std::vector<Square>& sweep)
+	constexpr pieces::Color getOtherColor(pieces::Color color)
 	{
-		for (const Square sq : sweep)
-		{
-			const Piece other = board.getPiece(sq);
-			if (other != pieces::none)
-			{
-				assert(EngineUtilities::isNonNonePiece(other));
-				return other;
-			}
-		}
-
-		return pieces::none;
+		return color == pieces::Color::WHITE ? pieces::Color::BLACK : pieces::Color::WHITE;
 	}
 
-	bool isSquareReachableByBlack(const BoardState& board, Square sq,
-		const FastSqLookup& fastSqLookup)
+	// The white piece plus the offset is the piece of the color.
+	constexpr Piece getPieceOffset(pieces::Color color)
 	{
-		// Check diagonals (not pawns or king though, they are checked futher below).
-		const Piece dA8 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsA8()[sq]);
-		if (EngineUtilities::isBlack(dA8) && (dA8 == pieces::bQ || dA8 == pieces::bB)) { return true; }
-
-		const Piece dH8 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsH8()[sq]);
-		if (EngineUtilities::isBlack(dH8) && (dH8 == pieces::bQ || dH8 == pieces::bB)) { return true; }
-
-		const Piece dH1 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsH1()[sq]);
-		if (EngineUtilities::isBlack(dH1) && (dH1 == pieces::bQ || dH1 == pieces::bB)) { return true; }
-
-		const Piece dA1 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsA1()[sq]);
-		if (EngineUtilities::isBlack(dA1) && (dA1 == pieces::bQ || dA1 == pieces::bB)) { return true; }
-
-		// Check straights.
-		const Piece sRMin = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsRankMin()[sq]);
-		if (EngineUtilities::isBlack(sRMin) && (sRMin == pieces::bQ || sRMin == pieces::bR)) { return true; }
-
-		const Piece sRMax = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsRankMax()[sq]);
-		if (EngineUtilities::isBlack(sRMax) && (sRMax == pieces::bQ || sRMax == pieces::bR)) { return true; }
-
-		const Piece sFmin = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsFileMin()[sq]);
-		if (EngineUtilities::isBlack(sFmin) && (sFmin == pieces::bQ || sFmin == pieces::bR)) { return true; }
+		return color == pieces::Color::WHITE ? pieces::wK : pieces::bK;
+	}
 
-		const Piece sFMax = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsFileMax()[sq]);
-		if (EngineUtilities::isBlack(sFMax) && (sFMax == pieces::bQ || sFMax == pieces::bR)) { return true; }
+	// The square as seen from the color's side of the board, e.g. e1 is e8 for black.
+	constexpr Square getRelativeSquare(pieces::Color color, Square sq)
+	{
+		return color == pieces::Color::WHITE ? sq : sq ^ squares::a8;
+	}
 
-		// Check pawns (it is not an error that we use the same color pawn captures here).
-		for (const Square pSq : fastSqLookup.getWhitePawnCaptureSquares()[sq])
-		{
-			if (board.getPiece(pSq) == pieces::bP) { return true; }
-		}
+	constexpr Rank getRelativeRank(pieces::Color color, Rank rank)
+	{
+		return color == pieces::Color::WHITE ? rank : ranks::rank8 - rank;
+	}
 
-		// Check king.
-		for (const Square kSq : fastSqLookup.getkingNonCastlingReachableSquares()[sq])
+	// The squares that a pawn of the color attacks from sq.
+	template<pieces::Color color>
+	Bitboard getPawnAttacks(Square sq)
+	{
+		if constexpr (color == pieces::Color::WHITE)
 		{
-			if (board.getPiece(kSq) == pieces::bK) { return true; }
+			return bitboards::getWhitePawnAttacks(sq);
 		}
-
-		// Check knights.
-		for (const Square nSq : fastSqLookup.getknightReachableSquares()[sq])
+		else
 		{
-			if (board.getPiece(nSq) == pieces::bN) { return true; }
+			return bitboards::getBlackPawnAttacks(sq);
 		}
-
-		return false;
 	}
 
-	bool isSquareReachableByWhite(const BoardState& board, Square sq,
-		const FastSqLookup& fastSqLookup)
+	// All pieces of the given color that attack the square, given the occupied squares.
+	template<pieces::Color attackingColor>
+	Bitboard getAttackers(const BoardState& board, Square sq, Bitboard occupied)
 	{
-		// Check diagonals (not pawns or king though, they are checked futher below).
-		const Piece dA8 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsA8()[sq]);
-		if (EngineUtilities::isWhite(dA8) && (dA8 == pieces::wQ || dA8 == pieces::wB)) { return true; }
+		using namespace bitboards;
+		constexpr Piece offset = getPieceOffset(attackingColor);
+		const Bitboard queens = board.getPieceBitboard(offset + pieces::wQ);
+		const Bitboard diagonalAttackers = board.getPieceBitboard(offset + pieces::wB) | queens;
+		const Bitboard straightAttackers = board.getPieceBitboard(offset + pieces::wR) | queens;
 
-		const Piece dH8 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsH8()[sq]);
-		if (EngineUtilities::isWhite(dH8) && (dH8 == pieces::wQ || dH8 == pieces::wB)) { return true; }
+		// It is not an error that the opposite color pawn captures are used here.
+		return (getBishopAttacks(sq, occupied) & diagonalAttackers) |
+			(getRookAttacks(sq, occupied) & straightAttackers) |
+			(getPawnAttacks<getOtherColor(attackingColor)>(sq) &
+				board.getPieceBitboard(offset + pieces::wP)) |
+			(getKingAttacks(sq) & board.getPieceBitboard(offset + pieces::wK)) |
+			(getKnightAttacks(sq) & board.getPieceBitboard(offset + pieces::wN));
+	}
 
-		const Piece dH1 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsH1()[sq]);
-		if (EngineUtilities::isWhite(dH1) && (dH1 == pieces::wQ || dH1 == pieces::wB)) { return true; }
+	template<pieces::Color attackingColor>
+	bool isSquareReachable(const BoardState& board, Square sq, Bitboard occupied)
+	{
+		using namespace bitboards;
+		constexpr Piece offset = getPieceOffset(attackingColor);
 
-		const Piece dA1 = getPieceAtEndOfSweep(board, fastSqLookup.getDiagTowardsA1()[sq]);
-		if (EngineUtilities::isWhite(dA1) && (dA1 == pieces::wQ || dA1 == pieces::wB)) { return true; }
+		// Check diagonals (not pawns or king though, they are checked futher below).
+		const Bitboard queens = board.getPieceBitboard(offset + pieces::wQ);
+		const Bitboard diagonalAttackers = board.getPieceBitboard(offset + pieces::wB) | queens;
+		if (getBishopAttacks(sq, occupied) & diagonalAttackers) { return true; }
 
 		// Check straights.
-		const Piece sRMin = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsRankMin()[sq]);
-		if (EngineUtilities::isWhite(sRMin) && (sRMin == pieces::wQ || sRMin == pieces::wR)) { return true; }
+		const Bitboard straightAttackers = board.getPieceBitboard(offset + pieces::wR) | queens;
+		if (getRookAttacks(sq, occupied) & straightAttackers) { return true; }
 
-		const Piece sRMax = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsRankMax()[sq]);
-		if (EngineUtilities::isWhite(sRMax) && (sRMax == pieces::wQ || sRMax == pieces::wR)) { return true; }
-
-		const Piece sFmin = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsFileMin()[sq]);
-		if (EngineUtilities::isWhite(sFmin) && (sFmin == pieces::wQ || sFmin == pieces::wR)) { return true; }
-
-		const Piece sFMax = getPieceAtEndOfSweep(board, fastSqLookup.getstraightTowardsFileMax()[sq]);
-		if (EngineUtilities::isWhite(sFMax) && (sFMax == pieces::wQ || sFMax == pieces::wR)) { return true; }
-
-		// Check pawns (it is not an error that we use the same color pawn captures here).
-		for (const Square pSq : fastSqLookup.getBlackPawnCaptureSquares()[sq])
-		{
-			if (board.getPiece(pSq) == pieces::wP) { return true; }
-		}
+		// Check pawns (it is not an error that we use the other color pawn captures here).
+		if (getPawnAttacks<getOtherColor(attackingColor)>(sq) &
+			board.getPieceBitboard(offset + pieces::wP)) { return true; }
 
 		// Check king.
-		for (const Square kSq : fastSqLookup.getkingNonCastlingReachableSquares()[sq])
-		{
-			if (board.getPiece(kSq) == pieces::wK) { return true; }
-		}
+		if (getKingAttacks(sq) & board.getPieceBitboard(offset + pieces::wK)) { return true; }
 
 		// Check knights.
-		for (const Square nSq : fastSqLookup.getknightReachableSquares()[sq])
-		{
-			if (board.getPiece(nSq) == pieces::wN) { return true; }
-		}
-
-		return false;
-	}
-
-	bool isWhiteInCheck(const BoardState& board, const FastSqLookup& fastSqLookup)
-	{
-		assert(board.getPiece(board.getWhiteKingSquare()) == pieces::wK);
-		return isSquareReachableByBlack(board, board.getWhiteKingSquare(), fastSqLookup);
+		return (getKnightAttacks(sq) & board.getPieceBitboard(offset + pieces::wN)) != 0;
 	}
 
-	bool isBlackInCheck(const BoardState& board, const FastSqLookup& fastSqLookup)
+	template<pieces::Color attackingColor>
+	bool isSquareReachable(const BoardState& board, Square sq)
 	{
-		assert(board.getPiece(board.getBlackKingSquare()) == pieces::bK);
-		return isSquareReachableByWhite(board, board.getBlackKingSquare(), fastSqLookup);
+		return isSquareReachable<attackingColor>(board, sq, board.getOccupiedBitboard());
 	}
 
-	bool doesWhiteMoveCauseMovingSideCheck(BoardState& board, const FastSqLookup& fastSqLookup,
-		const Move& move, bool wasInCheckPreMove)
+	template<pieces::Color color>
+	Square getKingSquare(const BoardState& board)
 	{
-		if (wasInCheckPreMove)
+		if constexpr (color == pieces::Color::WHITE)
 		{
-			if (move.capturedPiece == pieces::none && !fastSqLookup.areSquaresInLinearLineOfSight(
-				move.toSquare, board.getWhiteKingSquare()) && move.movingPiece != pieces::wK)
-			{
-				// Non-capturing, non-king move ending up not in line of sight of the king cannot
-				// make us not in check, so this move will make the moving side still be in check.
-				return true;
-			}
+			return board.getWhiteKingSquare();
 		}
 		else
 		{
-			if (!fastSqLookup.areSquaresInLinearLineOfSight(move.fromSquare, board.getWhiteKingSquare())
-				&& move.movingPiece != pieces::wK && move.toSquare != board.getEnPassantSquare())
-			{
-				return false;
-			}
+			return board.getBlackKingSquare();
 		}
+	}
 
-		// Above optimizations failed, temporarily make the move, and look for check.
-		board.makeMove(move);
-		const bool causesCheck = isWhiteInCheck(board, fastSqLookup);
-		board.unmakeMove(move);
-		return causesCheck;
+	template<pieces::Color color>
+	bool isInCheck(const BoardState& board)
+	{
+		assert(board.getPiece(getKingSquare<color>(board)) == getPieceOffset(color) + pieces::wK);
+		return isSquareReachable<getOtherColor(color)>(board, getKingSquare<color>(board));
 	}
 
-	bool doesBlackMoveCauseMovingSideCheck(BoardState& board, const FastSqLookup& fastSqLookup,
-		const Move& move, bool wasInCheckPreMove)
+	// If the moving side is in check.
+	bool isInCheck(const BoardState& board)
 	{
-		if (wasInCheckPreMove)
+		if (board.getTurn() == pieces::Color::WHITE)
 		{
-			if (move.capturedPiece == pieces::none && !fastSqLookup.areSquaresInLinearLineOfSight(
-				move.toSquare, board.getBlackKingSquare()) && move.movingPiece != pieces::bK)
-			{
-				// Non-capturing, non-king move ending up not in line of sight of the king cannot
-				// make us not in check, so this move will make the moving side still be in check.
-				return true;
-			}
+			return isInCheck<pieces::Color::WHITE>(board);
 		}
 		else
 		{
-			if (!fastSqLookup.areSquaresInLinearLineOfSight(move.fromSquare, board.getBlackKingSquare())
-				&& move.movingPiece != pieces::bK && move.toSquare != board.getEnPassantSquare())
-			{
-				return false;
-			}
+			return isInCheck<pieces::Color::BLACK>(board);
 		}
+	}
 
-		// Above optimizations failed, temporarily make the move, and look for check.
+	// Slow, since it makes the move. Only meant for testing the move generation.
+	bool doesMoveCauseMovingSideCheck(BoardState& board, const Move& move)
+	{
+		const pieces::Color movingSide = board.getTurn();
 		board.makeMove(move);
-		const bool causesCheck = isBlackInCheck(board, fastSqLookup);
+		const bool causesCheck = movingSide == pieces::Color::WHITE ?
+			isInCheck<pieces::Color::WHITE>(board) : isInCheck<pieces::Color::BLACK>(board);
 		board.unmakeMove(move);
 		return causesCheck;
 	}
 
-	bool doesMoveCauseMovingSideCheck(BoardState& board, const FastSqLookup& fastSqLookup,
-		const Move& move, bool wasInCheckPreMove)
+	// Finds the checking and the pinned pieces, so that only legal moves need to be generated.
+	template<pieces::Color color>
+	void initLegalityMasks(const BoardState& board, Lookup& lookup)
 	{
-		// Optimization: if the side whos turn it is was not in check before making the move, a
-		// move that involves moving a piece that is not in line with its own king prior to making
-		// the move cannot cause the moving side to move itself into check. This is true as long as
-		// the moving piece is not the king itself or if making an en passant capture. 
-		// Simularly, if the moving side was already in check before the move, any non-capturing
-		// move with its end square not in line with its own king cannot make the moving side not
-		// in check. We use these facts here to not having to do the move to determine if it would
-		// cause a check or not.
-		if (board.getTurn() == pieces::Color::WHITE)
+		using namespace bitboards;
+		constexpr pieces::Color otherSide = getOtherColor(color);
+		constexpr Piece otherOffset = getPieceOffset(otherSide);
+		const Bitboard occupied = board.getOccupiedBitboard();
+		lookup.kingSq = getKingSquare<color>(board);
+
+		const Bitboard checkers = getAttackers<otherSide>(board, lookup.kingSq, occupied);
+		if (checkers == empty)
 		{
-			return doesWhiteMoveCauseMovingSideCheck(board, fastSqLookup, move, wasInCheckPreMove);
+			lookup.checkMask = all;
 		}
-		else
+		else if ((checkers & (checkers - 1)) == empty)
 		{
-			return doesBlackMoveCauseMovingSideCheck(board, fastSqLookup, move, wasInCheckPreMove);
+			// Single check, capture the checking piece or block it (if it is a sliding piece).
+			const Square checkerSq = lsb(checkers);
+			lookup.checkMask = checkers | getBetween(lookup.kingSq, checkerSq);
 		}
-	}
-
-	bool isInCheck(BoardState& board, const FastSqLookup& fastSqLookup)
-	{
-		if (board.getTurn() == pieces::Color::WHITE)
+		else
 		{
-			return isWhiteInCheck(board, fastSqLookup);
+			// Double check, only the king can move.
+			lookup.checkMask = empty;
 		}
-		else
+
+		// A piece is pinned if it is the only piece between the king and an enemy sliding piece.
+		const Bitboard queens = board.getPieceBitboard(otherOffset + pieces::wQ);
+		Bitboard snipers =
+			(getRookAttacks(lookup.kingSq, empty) &
+				(board.getPieceBitboard(otherOffset + pieces::wR) | queens)) |
+			(getBishopAttacks(lookup.kingSq, empty) &
+				(board.getPieceBitboard(otherOffset + pieces::wB) | queens));
+		const Bitboard own = board.getColorBitboard(color);
+		lookup.pinned = empty;
+		while (snipers)
 		{
-			return isBlackInCheck(board, fastSqLookup);
+			const Bitboard blockers = getBetween(lookup.kingSq, popLsb(snipers)) & occupied;
+			if (blockers != empty && (blockers & (blockers - 1)) == empty && (blockers & own))
+			{
+				lookup.pinned |= blockers;
+			}
 		}
 	}
 
-	// Ensures that the moving side is not in check prior to adding the move.
-	void addWhiteIfValid(BoardState& board, const Move& move, std::vector<Move>& moves,
-		const Lookup& lookup)
+	// The squares that the (non-king) piece on sq may move to without leaving its king in check.
+	Bitboard getLegalTargetMask(Square sq, const Lookup& lookup)
 	{
-		assert(board.getTurn() == pieces::Color::WHITE);
-		if (lookup.lFilter == LegalityFilter::PseudoLegal)
+		if (lookup.pinned & bitboards::toBitboard(sq))
 		{
-			// We don't need to look for check, just add and return.
-			moves.push_back(move);
-			return;
+			return lookup.checkMask & bitboards::getLine(lookup.kingSq, sq);
 		}
 
-#ifndef NDEBUG
-		const BoardState boardPreMove = board;
-#endif
+		return lookup.checkMask;
+	}
 
-		if (doesWhiteMoveCauseMovingSideCheck(board, lookup.fSqL, move, lookup.movingSideInCheckPreMove))
+	// An en passant capture removes two pieces from the same rank, which may uncover an attack on
+	// the king that the pin detection does not see. It is rare enough to be handled on its own.
+	template<pieces::Color color, LegalityFilter lFilter>
+	bool isEnPassantCaptureLegal(const BoardState& board, Square fromSquare, Square toSquare,
+		const Lookup& lookup)
+	{
+		using namespace bitboards;
+		if constexpr (lFilter == LegalityFilter::PseudoLegal)
 		{
-			// Filter out any moves that causes moving-side check since that is an invalid move.
-			return;
+			return true;
 		}
 
-		moves.push_back(move);
-		assert(board == boardPreMove);
+		const Square capturedSq = color == pieces::Color::WHITE ? toSquare - 8 : toSquare + 8;
+		const Bitboard occupied = (board.getOccupiedBitboard() ^ toBitboard(fromSquare) ^
+			toBitboard(capturedSq)) | toBitboard(toSquare);
+		return (getAttackers<getOtherColor(color)>(board, lookup.kingSq, occupied) &
+			~toBitboard(capturedSq)) == empty;
 	}
 
-	// Ensures that the moving side is not in check prior to adding the move.
-	void addBlackIfValid(BoardState& board, const Move& move,
-		std::vector<Move>& moves, const Lookup& lookup)
+	// The squares around the king that it may move to without being in check.
+	template<pieces::Color color, LegalityFilter lFilter>
+	Bitboard getLegalKingTargetMask(const BoardState& board, Square kingSq)
 	{
-		assert(board.getTurn() == pieces::Color::BLACK);
-		if (lookup.lFilter == LegalityFilter::PseudoLegal)
+		if constexpr (lFilter == LegalityFilter::PseudoLegal)
 		{
-			// We don't need to look for check, just add and return.
-			moves.push_back(move);
-			return;
+			return bitboards::all;
 		}
 
-
-#ifndef NDEBUG
-		const BoardState boardPreMove = board;
-#endif
-
-		if (doesBlackMoveCauseMovingSideCheck(board, lookup.fSqL, move, lookup.movingSideInCheckPreMove))
+		// The king itself is removed from the occupancy, so that it can not hide behind itself
+		// when moving away from a sliding piece along the line of attack.
+		const Bitboard occupied = board.getOccupiedBitboard() ^ bitboards::toBitboard(kingSq);
+		Bitboard mask = bitboards::empty;
+		Bitboard targets = bitboards::getKingAttacks(kingSq) & ~board.getColorBitboard(color);
+		while (targets)
 		{
-			// Filter out any moves that causes moving-side check since that is an invalid move.
-			return;
+			const Square sq = bitboards::popLsb(targets);
+			if (getAttackers<getOtherColor(color)>(board, sq, occupied) == bitboards::empty)
+			{
+				mask |= bitboards::toBitboard(sq);
+			}
 		}
 
-		moves.push_back(move);
-		assert(board == boardPreMove);
+		return mask;
 	}
 
-	bool rookCaptureProhibitsWQcastling(const BoardState& board, Square captureSquare)
+	// The squares that a piece of the color can move to, given the attacked squares of that piece.
+	template<pieces::Color color, TypeFilter tFilter>
+	Bitboard getTargetSquares(const BoardState& board, Bitboard attacks)
 	{
-		assert(board.getPiece(captureSquare) == pieces::wR);
-		assert(board.getTurn() == pieces::Color::BLACK);
-		return captureSquare == squares::a1 && board.getCastleAvailability().find('Q')->second;
-	}
-
-	bool rookCaptureProhibitsWKcastling(const BoardState& board, Square captureSquare)
-	{
-		assert(board.getPiece(captureSquare) == pieces::wR);
-		assert(board.getTurn() == pieces::Color::BLACK);
-		return captureSquare == squares::h1 && board.getCastleAvailability().find('K')->second;
-	}
-
-	bool rookCaptureProhibitsBQcastling(const BoardState& board, Square captureSquare)
-	{
-		assert(board.getPiece(captureSquare) == pieces::bR);
-		assert(board.getTurn() == pieces::Color::WHITE);
-		return captureSquare == squares::a8 && board.getCastleAvailability().find('q')->second;
-	}
-
-	bool rookCaptureProhibitsBKcastling(const BoardState& board, Square captureSquare)
-	{
-		assert(board.getPiece(captureSquare) == pieces::bR);
-		assert(board.getTurn() == pieces::Color::WHITE);
-		return captureSquare == squares::h8 && board.getCastleAvailability().find('k')->second;
-	}
-
-
-	// Note: Does not handle en passant square creation, pawn promotion, casteling or
-	// castling avaialibity.
-	Move createRegularSilentMove(const BoardState& board, Square fromSquare, Square toSquare)
-	{
-		return Move(board.getPiece(fromSquare), fromSquare, toSquare, board.getEnPassantSquare());
+		if constexpr (tFilter == TypeFilter::CaptAndPromot)
+		{
+			return attacks & board.getColorBitboard(getOtherColor(color));
+		}
+		else if constexpr (tFilter == TypeFilter::Quiet)
+		{
+			return attacks & ~board.getOccupiedBitboard();
+		}
+		else
+		{
+			return attacks & ~board.getColorBitboard(color);
+		}
 	}
 
-	// Note: Does not handle pawn promotion, en passant captures or castling avaialibity
-	// due to rook or king moved. Does handle castling availability due to captured rook though.
-	Move createWhiteRegularCapturingMove(const BoardState& board, Square fromSquare, Square toSquare)
+	template<pieces::Color color, TypeFilter tFilter>
+	void addRegularMoves(const BoardState& board, Square sq, Bitboard attacks, MoveList& moves)
 	{
-		assert(board.getTurn() == pieces::Color::WHITE);
-
-		const Piece capturedPiece = board.getPiece(toSquare);
-		Move move(board.getPiece(fromSquare), fromSquare, toSquare, board.getEnPassantSquare(),
-			capturedPiece, toSquare);
-
-		// Handle castling availability if a rook was captured.
-		if (capturedPiece == pieces::bR)
+		assert(board.getTurn() == color);
+		assert(EngineUtilities::isNonNonePiece(board.getPiece(sq)));
+		assert(EngineUtilities::isWhite(board.getPiece(sq)) == (color == pieces::Color::WHITE));
+		const Bitboard enemies = board.getColorBitboard(getOtherColor(color));
+		Bitboard targets = getTargetSquares<color, tFilter>(board, attacks);
+		while (targets)
 		{
-			if (rookCaptureProhibitsBKcastling(board, toSquare))
+			const Square toSq = bitboards::popLsb(targets);
+			uint8_t flags = moveFlags::quiet;
+			if constexpr (tFilter == TypeFilter::CaptAndPromot)
 			{
-				move.prohibitsBKcastling = true;
+				flags = moveFlags::capture;
 			}
-			else if (rookCaptureProhibitsBQcastling(board, toSquare))
+			else if constexpr (tFilter == TypeFilter::All)
 			{
-				move.prohibitsBQcastling = true;
+				flags = (enemies & bitboards::toBitboard(toSq)) ? moveFlags::capture : moveFlags::quiet;
 			}
-		}
 
-		return move;
+			moves.push_back(Move(sq, toSq, flags));
+		}
 	}
 
-	// Note: Does not handle pawn promotion, en passant captures or castling avaialibity
-	// due to rook or king moved. Does handle castling availability due to captured rook though.
-	Move createBlackRegularCapturingMove(const BoardState& board, Square fromSquare, Square toSquare)
+	// The promotion flags, in the order that the promotions are generated (best piece first).
+	static constexpr uint8_t promotionFlags[] = {moveFlags::queenPromotion,
+		moveFlags::rookPromotion, moveFlags::bishopPromotion, moveFlags::knightPromotion};
+
+	// The captureFlag is either moveFlags::capture or 0.
+	template<pieces::Color color>
+	void addPawnPromotions([[maybe_unused]] const BoardState& board, Square fromSquare,
+		Square toSquare, uint8_t captureFlag, MoveList& moves)
 	{
-		assert(board.getTurn() == pieces::Color::BLACK);
-		const Piece capturedPiece = board.getPiece(toSquare);
-		Move move(board.getPiece(fromSquare), fromSquare, toSquare, board.getEnPassantSquare(),
-			capturedPiece, toSquare);
+		assert(getRelativeRank(color, ranks::toRank(fromSquare)) == ranks::rank7);
+		assert(getRelativeRank(color, ranks::toRank(toSquare)) == ranks::rank8);
+		assert(captureFlag == 0 || EngineUtilities::isWhite(board.getPiece(toSquare)) ==
+			(color == pieces::Color::BLACK));
 
-		// Handle castling availability if a rook was captured.
-		if (capturedPiece == pieces::wR)
+		for (const uint8_t flags : promotionFlags)
 		{
-			if (rookCaptureProhibitsWKcastling(board, toSquare))
-			{
-				move.prohibitsWKcastling = true;
-			}
-			else if (rookCaptureProhibitsWQcastling(board, toSquare))
-			{
-				move.prohibitsWQcastling = true;
-			}
+			moves.push_back(Move(fromSquare, toSquare, flags | captureFlag));
 		}
-
-		return move;
 	}
 
-	void addWhiteRegularSweepMoves(BoardState& board, Square sq,
-		const std::array<std::vector<Square>, squares::num>& trySqs, std::vector<Move>& moves,
-		const Lookup& lookup)
+	// The castling functions check that the king is not in check, and that it does not pass or end
+	// on an attacked square.
+	template<pieces::Color color>
+	bool canCastleKingSide(const BoardState& board)
 	{
-		assert(board.getTurn() == pieces::Color::WHITE);
-		assert(EngineUtilities::isWhite(board.getPiece(sq)));
-		for (const Square nextSq : trySqs[sq])
+		using namespace bitboards;
+		constexpr pieces::Color otherSide = getOtherColor(color);
+		constexpr CastlingRights right = color == pieces::Color::WHITE ?
+			castlingRights::wKingSide : castlingRights::bKingSide;
+		constexpr Square kingSq = getRelativeSquare(color, squares::e1);
+		constexpr Square passedSq = getRelativeSquare(color, squares::f1);
+		constexpr Square toSq = getRelativeSquare(color, squares::g1);
+		constexpr Bitboard emptySqs = toBitboard(passedSq) | toBitboard(toSq);
+		if (getKingSquare<color>(board) == kingSq && (board.getCastlingRights() & right) &&
+			!(board.getOccupiedBitboard() & emptySqs) &&
+			!isSquareReachable<otherSide>(board, passedSq) &&
+			!isSquareReachable<otherSide>(board, toSq) &&
+			!isSquareReachable<otherSide>(board, kingSq))
 		{
-			const Piece other = board.getPiece(nextSq);
-			if (other == pieces::none)
-			{
-				if (!(lookup.tFilter == TypeFilter::CaptAndPromot))
-				{
-					addWhiteIfValid(board, createRegularSilentMove(board, sq, nextSq), moves, lookup);
-				}
-			}
-			else if (EngineUtilities::isBlack(other))
-			{
-				addWhiteIfValid(board, createWhiteRegularCapturingMove(board, sq, nextSq),
-					moves, lookup);
-				return;
-			}
-			else
-			{
-				return; // Found same colored piece.
-			}
+			assert(board.getPiece(getRelativeSquare(color, squares::h1)) ==
+				getPieceOffset(color) + pieces::wR);
+			return true;
 		}
+
+		return false;
 	}
 
-	void addBlackRegularSweepMoves(BoardState& board, Square sq,
-		const std::array<std::vector<Square>, squares::num>& trySqs, std::vector<Move>& moves,
-		const Lookup& lookup)
+	template<pieces::Color color>
+	bool canCastleQueenSide(const BoardState& board)
 	{
-		assert(board.getTurn() == pieces::Color::BLACK);
-		assert(EngineUtilities::isBlack(board.getPiece(sq)));
-		for (const Square nextSq : trySqs[sq])
+		using namespace bitboards;
+		constexpr pieces::Color otherSide = getOtherColor(color);
+		constexpr CastlingRights right = color == pieces::Color::WHITE ?
+			castlingRights::wQueenSide : castlingRights::bQueenSide;
+		constexpr Square kingSq = getRelativeSquare(color, squares::e1);
+		constexpr Square passedSq = getRelativeSquare(color, squares::d1);
+		constexpr Square toSq = getRelativeSquare(color, squares::c1);
+		constexpr Bitboard emptySqs = toBitboard(getRelativeSquare(color, squares::b1)) |
+			toBitboard(toSq) | toBitboard(passedSq);
+		if (getKingSquare<color>(board) == kingSq && (board.getCastlingRights() & right) &&
+			!(board.getOccupiedBitboard() & emptySqs) &&
+			!isSquareReachable<otherSide>(board, passedSq) &&
+			!isSquareReachable<otherSide>(board, toSq) &&
+			!isSquareReachable<otherSide>(board, kingSq))
 		{
-			const Piece other = board.getPiece(nextSq);
-			if (other == pieces::none)
-			{
-				if (!(lookup.tFilter == TypeFilter::CaptAndPromot))
-				{
-					addBlackIfValid(board, createRegularSilentMove(board, sq, nextSq), moves, lookup);
-				}
-			}
-			else if (EngineUtilities::isWhite(other))
-			{
-				addBlackIfValid(board, createBlackRegularCapturingMove(board, sq, nextSq),
-					moves, lookup);
-				return;
-			}
-			else
-			{
-				return; // Found same colored piece.
-			}
+			assert(board.getPiece(getRelativeSquare(color, squares::a1)) ==
+				getPieceOffset(color) + pieces::wR);
+			return true;
 		}
+
+		return false;
 	}
 
-	void addWhiteRegularNonSweepMoves(BoardState& board, Square sq,
-		const std::array<std::vector<Square>, squares::num>& trySqs, std::vector<Move>& moves,
-		const Lookup& lookup)
+	template<pieces::Color color, TypeFilter tFilter, LegalityFilter lFilter>
+	void addKingMoves(const BoardState& board, Square sq, MoveList& moves)
 	{
-		assert(board.getTurn() == pieces::Color::WHITE);
-		assert(EngineUtilities::isWhite(board.getPiece(sq)));
-		for (const Square nextSq : trySqs[sq])
+		using namespace bitboards;
+		assert(board.getTurn() == color);
+		assert(board.getPiece(sq) == getPieceOffset(color) + pieces::wK);
+
+		// Non castling moves.
+		addRegularMoves<color, tFilter>(board, sq,
+			getKingAttacks(sq) & getLegalKingTargetMask<color, lFilter>(board, sq), moves);
+
+		if constexpr (tFilter == TypeFilter::CaptAndPromot)
 		{
-			const Piece other = board.getPiece(nextSq);
-			if (other == pieces::none && !(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				addWhiteIfValid(board, createRegularSilentMove(board, sq, nextSq), moves, lookup);
-			}
-			else if (EngineUtilities::isBlack(other))
-			{
-				addWhiteIfValid(board, createWhiteRegularCapturingMove(board, sq, nextSq),
-					moves, lookup);
-			}
+			return;
 		}
-	}
 
-	void addBlackRegularNonSweepMoves(BoardState& board, Square sq,
-		const std::array<std::vector<Square>, squares::num>& trySqs, std::vector<Move>& moves,
-		const Lookup& lookup)
-	{
-		assert(board.getTurn() == pieces::Color::BLACK);
-		assert(EngineUtilities::isBlack(board.getPiece(sq)));
-		for (const Square nextSq : trySqs[sq])
+		// Castling moves.
+		if (canCastleKingSide<color>(board))
 		{
-			const Piece other = board.getPiece(nextSq);
-			if (other == pieces::none && !(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				addBlackIfValid(board, createRegularSilentMove(board, sq, nextSq), moves, lookup);
-			}
-			else if (EngineUtilities::isWhite(other))
-			{
-				addBlackIfValid(board, createBlackRegularCapturingMove(board, sq, nextSq),
-					moves, lookup);
-			}
+			moves.push_back(Move(sq, getRelativeSquare(color, squares::g1), moveFlags::kingCastle));
 		}
-	}
-
-	bool rookMoveProhibitsWKCastling(const BoardState& board, Square fromSquare)
-	{
-		assert(board.getPiece(fromSquare) == pieces::wR);
-		assert(board.getTurn() == pieces::Color::WHITE);
-		return fromSquare == squares::h1 && board.getCastleAvailability().find('K')->second;
-	}
 
-	bool rookMoveProhibitsWQCastling(const BoardState& board, Square fromSquare)
-	{
-		assert(board.getPiece(fromSquare) == pieces::wR);
-		assert(board.getTurn() == pieces::Color::WHITE);
-		return fromSquare == squares::a1 && board.getCastleAvailability().find('Q')->second;
+		if (canCastleQueenSide<color>(board))
+		{
+			moves.push_back(Move(sq, getRelativeSquare(color, squares::c1), moveFlags::queenCastle));
+		}
 	}
 
-	bool rookMoveProhibitsBKCastling(const BoardState& board, Square fromSquare)
+	template<pieces::Color color, TypeFilter tFilter, LegalityFilter lFilter>
+	void addPawnMoves(const BoardState& board, Square sq, const Lookup& lookup, MoveList& moves)
 	{
-		assert(board.getPiece(fromSquare) == pieces::bR);
-		assert(board.getTurn() == pieces::Color::BLACK);
-		return fromSquare == squares::h8 && board.getCastleAvailability().find('k')->second;
-	}
+		using namespace bitboards;
+		constexpr Square advance = color == pieces::Color::WHITE ? 8 : -8;
+		assert(board.getTurn() == color);
+		assert(board.getPiece(sq) == getPieceOffset(color) + pieces::wP);
 
-	bool rookMoveProhibitsBQCastling(const BoardState& board, Square fromSquare)
-	{
-		assert(board.getPiece(fromSquare) == pieces::bR);
-		assert(board.getTurn() == pieces::Color::BLACK);
-		return fromSquare == squares::a8 && board.getCastleAvailability().find('q')->second;
-	}
+		// A pawn should never be at the last rank, ready to move.
+		const Rank rank = getRelativeRank(color, ranks::toRank(sq));
+		assert(rank <= ranks::rank7);
+		const Bitboard occupied = board.getOccupiedBitboard();
+		const Bitboard legalTargets = getLegalTargetMask(sq, lookup);
 
-	void addWhiteRookSweepMoves(BoardState& board, Square sq,
-		const std::array<std::vector<Square>, squares::num>& trySqs, std::vector<Move>& moves,
-		const Lookup& lookup)
-	{
-		assert(board.getTurn() == pieces::Color::WHITE);
-		assert(board.getPiece(sq) == pieces::wR);
-		const bool prohibitsWKcastle = rookMoveProhibitsWKCastling(board, sq);
-		const bool prohibitsWQcastle = rookMoveProhibitsWQCastling(board, sq);
-		for (const Square nextSq : trySqs[sq])
+		// Single pawn advance.
+		const Square singleAdvanceSq = sq + advance;
+		if (!(occupied & toBitboard(singleAdvanceSq)))
 		{
-			const Piece other = board.getPiece(nextSq);
-			if (other == pieces::none)
+			if (legalTargets & toBitboard(singleAdvanceSq))
 			{
-				if (!(lookup.tFilter == TypeFilter::CaptAndPromot))
+				if (rank == ranks::rank7) // Pawn promotion.
 				{
-					Move move = createRegularSilentMove(board, sq, nextSq);
-					move.prohibitsWKcastling = prohibitsWKcastle;
-					move.prohibitsWQcastling = prohibitsWQcastle;
-					addWhiteIfValid(board, move, moves, lookup);
+					if constexpr (tFilter != TypeFilter::Quiet)
+					{
+						addPawnPromotions<color>(board, sq, singleAdvanceSq, 0, moves);
+					}
+				}
+				else if constexpr (tFilter != TypeFilter::CaptAndPromot)
+				{
+					moves.push_back(Move(sq, singleAdvanceSq));
 				}
 			}
-			else if (EngineUtilities::isBlack(other))
-			{
-				Move move = createWhiteRegularCapturingMove(board, sq, nextSq);
-				move.prohibitsWKcastling = prohibitsWKcastle;
-				move.prohibitsWQcastling = prohibitsWQcastle;
-				addWhiteIfValid(board, move, moves, lookup);
-				return;
-			}
-			else
-			{
-				return; // Found same colored piece.
-			}
-		}
-	}
 
-	void addBlackRookSweepMoves(BoardState& board, Square sq,
-		const std::array<std::vector<Square>, squares::num>& trySqs, std::vector<Move>& moves,
-		const Lookup& lookup)
-	{
-		assert(board.getTurn() == pieces::Color::BLACK);
-		assert(board.getPiece(sq) == pieces::bR);
-		const bool prohibitsBKcastle = rookMoveProhibitsBKCastling(board, sq);
-		const bool prohibitsBQcastle = rookMoveProhibitsBQCastling(board, sq);
-		for (const Square nextSq : trySqs[sq])
-		{
-			const Piece other = board.getPiece(nextSq);
-			if (other == pieces::none)
+			// Double pawn advance (may block a check even when the single advance does not).
+			if constexpr (tFilter != TypeFilter::CaptAndPromot)
 			{
-				if (!(lookup.tFilter == TypeFilter::CaptAndPromot))
+				const Square doubleAdvanceSq = sq + 2 * advance;
+				if (rank == ranks::rank2 && !(occupied & toBitboard(doubleAdvanceSq))
+					&& (legalTargets & toBitboard(doubleAdvanceSq)))
 				{
-					Move move = createRegularSilentMove(board, sq, nextSq);
-					move.prohibitsBKcastling = prohibitsBKcastle;
-					move.prohibitsBQcastling = prohibitsBQcastle;
-					addBlackIfValid(board, move, moves, lookup);
+					moves.push_back(Move(sq, doubleAdvanceSq, moveFlags::doublePawnPush));
 				}
 			}
-			else if (EngineUtilities::isWhite(other))
+		}
+
+		if constexpr (tFilter == TypeFilter::Quiet)
+		{
+			return;
+		}
+
+		// Pawn captures.
+		Bitboard captures = getPawnAttacks<color>(sq) &
+			board.getColorBitboard(getOtherColor(color)) & legalTargets;
+		while (captures)
+		{
+			const Square captureSq = popLsb(captures);
+			if (rank == ranks::rank7)
 			{
-				Move move = createBlackRegularCapturingMove(board, sq, nextSq);
-				move.prohibitsBKcastling = prohibitsBKcastle;
-				move.prohibitsBQcastling = prohibitsBQcastle;
-				addBlackIfValid(board, move, moves, lookup);
-				return;
+				addPawnPromotions<color>(board, sq, captureSq, moveFlags::capture, moves);
 			}
 			else
 			{
-				return; // Found same colored piece.
+				moves.push_back(Move(sq, captureSq, moveFlags::capture));
 			}
 		}
-	}
-
-	void addWhitePawnAdvanceWithPromotions(BoardState& board,
-		Square fromSquare, Square toSquare, std::vector<Move>& moves,
-		const Lookup& lookup)
-	{
-		assert(ranks::toRank(fromSquare) == ranks::rank7);
-		assert(ranks::toRank(toSquare) == ranks::rank8);
 
-		for (const auto promotion : {pieces::wQ, pieces::wR, pieces::wB, pieces::wN })
+		const Square eSq = board.getEnPassantSquare();
+		if (eSq != squares::none && (getPawnAttacks<color>(sq) & toBitboard(eSq)) &&
+			isEnPassantCaptureLegal<color, lFilter>(board, sq, eSq, lookup))
 		{
-			Move move = createRegularSilentMove(board, fromSquare, toSquare);
-			move.pawnPromotionPiece = promotion;
-			addWhiteIfValid(board, move, moves, lookup);
+			assert(board.getPiece(eSq - advance) == getPieceOffset(getOtherColor(color)) + pieces::wP);
+			moves.push_back(Move(sq, eSq, moveFlags::enPassantCapture));
 		}
 	}
 
-	void addBlackPawnAdvanceWithPromotions(BoardState& board, Square fromSquare,
-		Square toSquare, std::vector<Move>& moves, const Lookup& lookup)
+	template<pieces::Color color, TypeFilter tFilter, LegalityFilter lFilter>
+	void getMoves(const BoardState& board, MoveList& moves)
 	{
-		assert(ranks::toRank(fromSquare) == ranks::rank2);
-		assert(ranks::toRank(toSquare) == ranks::rank1);
+		using namespace bitboards;
+		constexpr Piece offset = getPieceOffset(color);
+		moves.clear();
 
-		for (const auto promotion : { pieces::bQ, pieces::bR, pieces::bB, pieces::bN })
+		Lookup lookup;
+		if constexpr (lFilter == LegalityFilter::StrictlyLegal)
 		{
-			Move move = createRegularSilentMove(board, fromSquare, toSquare);
-			move.pawnPromotionPiece = promotion;
-			addBlackIfValid(board, move, moves, lookup);
+			initLegalityMasks<color>(board, lookup);
 		}
-	}
-
-	void addWhitePawnCaptureWithPromotions(BoardState& board, Square fromSquare,
-		Square toSquare, std::vector<Move>& moves, const Lookup& lookup)
-	{
-		assert(ranks::toRank(fromSquare) == ranks::rank7);
-		assert(ranks::toRank(toSquare) == ranks::rank8);
-		assert(EngineUtilities::isBlack(board.getPiece(toSquare)));
 
-		for (const auto promotion : { pieces::wQ, pieces::wR, pieces::wB, pieces::wN })
+		const Bitboard occupied = board.getOccupiedBitboard();
+		for (Bitboard pawns = board.getPieceBitboard(offset + pieces::wP); pawns;)
 		{
-			Move move = createWhiteRegularCapturingMove(board, fromSquare, toSquare);
-			move.pawnPromotionPiece = promotion;
-			addWhiteIfValid(board, move, moves, lookup);
+			addPawnMoves<color, tFilter, lFilter>(board, popLsb(pawns), lookup, moves);
 		}
-	}
-
-	void addBlackPawnCaptureWithPromotions(BoardState& board, Square fromSquare,
-		Square toSquare, std::vector<Move>& moves, const Lookup& lookup)
-	{
-		assert(ranks::toRank(fromSquare) == ranks::rank2);
-		assert(ranks::toRank(toSquare) == ranks::rank1);
-		assert(EngineUtilities::isWhite(board.getPiece(toSquare)));
 
-		for (const auto promotion : { pieces::bQ, pieces::bR, pieces::bB, pieces::bN })
+		for (Bitboard knights = board.getPieceBitboard(offset + pieces::wN); knights;)
 		{
-			Move move = createBlackRegularCapturingMove(board, fromSquare, toSquare);
-			move.pawnPromotionPiece = promotion;
-			addBlackIfValid(board, move, moves, lookup);
+			const Square sq = popLsb(knights);
+			addRegularMoves<color, tFilter>(board, sq,
+				getKnightAttacks(sq) & getLegalTargetMask(sq, lookup), moves);
 		}
-	}
-
-	void addWhiteKingMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		assert(board.getTurn() == pieces::Color::WHITE);
-		assert(board.getPiece(sq) == pieces::wK);
-
-		const bool castleKAvailable = board.getCastleAvailability().find('K')->second;
-		const bool castleQAvailable = board.getCastleAvailability().find('Q')->second;
 
-		// Non castling moves.
-		for (const Square toSq : lookup.fSqL.getkingNonCastlingReachableSquares()[sq])
+		for (Bitboard bishops = board.getPieceBitboard(offset + pieces::wB); bishops;)
 		{
-			const Piece other = board.getPiece(toSq);
-			if (other == pieces::none && !(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				Move move = createRegularSilentMove(board, sq, toSq);
-				move.prohibitsWKcastling = castleKAvailable;
-				move.prohibitsWQcastling = castleQAvailable;
-				addWhiteIfValid(board, move, moves, lookup);
-			}
-			else if (EngineUtilities::isBlack(other))
-			{
-				Move move = createWhiteRegularCapturingMove(board, sq, toSq);
-				move.prohibitsWKcastling = castleKAvailable;
-				move.prohibitsWQcastling = castleQAvailable;
-				addWhiteIfValid(board, move, moves, lookup);
-			}
+			const Square sq = popLsb(bishops);
+			addRegularMoves<color, tFilter>(board, sq,
+				getBishopAttacks(sq, occupied) & getLegalTargetMask(sq, lookup), moves);
 		}
 
-		// Castling moves.
-		if (sq == squares::e1 && board.getPiece(squares::f1) == pieces::none &&
-			board.getPiece(squares::g1) == pieces::none && castleKAvailable &&
-			!isSquareReachableByBlack(board, squares::f1, lookup.fSqL) &&
-			!isSquareReachableByBlack(board, squares::e1, lookup.fSqL) &&
-			!(lookup.tFilter == TypeFilter::CaptAndPromot))
+		for (Bitboard rooks = board.getPieceBitboard(offset + pieces::wR); rooks;)
 		{
-			assert(board.getPiece(squares::h1) == pieces::wR);
-			Move move = createRegularSilentMove(board, sq, squares::g1);
-			move.prohibitsWKcastling = castleKAvailable;
-			move.prohibitsWQcastling = castleQAvailable;
-			addWhiteIfValid(board, move, moves, lookup);
+			const Square sq = popLsb(rooks);
+			addRegularMoves<color, tFilter>(board, sq,
+				getRookAttacks(sq, occupied) & getLegalTargetMask(sq, lookup), moves);
 		}
 
-		if (sq == squares::e1 && board.getPiece(squares::b1) == pieces::none &&
-			board.getPiece(squares::c1) == pieces::none && board.getPiece(squares::d1) == pieces::none
-			&& castleQAvailable && !isSquareReachableByBlack(board, squares::d1, lookup.fSqL)
-			&& !isSquareReachableByBlack(board, squares::e1, lookup.fSqL)
-			&& !(lookup.tFilter == TypeFilter::CaptAndPromot))
+		for (Bitboard queens = board.getPieceBitboard(offset + pieces::wQ); queens;)
 		{
-			assert(board.getPiece(squares::a1) == pieces::wR);
-			Move move = createRegularSilentMove(board, sq, squares::c1);
-			move.prohibitsWKcastling = castleKAvailable;
-			move.prohibitsWQcastling = castleQAvailable;
-			addWhiteIfValid(board, move, moves, lookup);
+			const Square sq = popLsb(queens);
+			addRegularMoves<color, tFilter>(board, sq,
+				getQueenAttacks(sq, occupied) & getLegalTargetMask(sq, lookup), moves);
 		}
+
+		addKingMoves<color, tFilter, lFilter>(board, getKingSquare<color>(board), moves);
 	}
 
-	void addBlackKingMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
+	// Picks the instantiation of getMoves() for the moving side.
+	template<TypeFilter tFilter, LegalityFilter lFilter = LegalityFilter::StrictlyLegal>
+	void getMovesOfMovingSide(const BoardState& board, MoveList& moves)
 	{
-		assert(board.getTurn() == pieces::Color::BLACK);
-		assert(board.getPiece(sq) == pieces::bK);
-		const bool castleKAvailable = board.getCastleAvailability().find('k')->second;
-		const bool castleQAvailable = board.getCastleAvailability().find('q')->second;
-
-		// Non castling moves.
-		for (const Square toSq : lookup.fSqL.getkingNonCastlingReachableSquares()[sq])
-		{
-			const Piece other = board.getPiece(toSq);
-			if (other == pieces::none && !(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				Move move = createRegularSilentMove(board, sq, toSq);
-				move.prohibitsBKcastling = castleKAvailable;
-				move.prohibitsBQcastling = castleQAvailable;
-				addBlackIfValid(board, move, moves, lookup);
-			}
-			else if (EngineUtilities::isWhite(other))
-			{
-				Move move = createBlackRegularCapturingMove(board, sq, toSq);
-				move.prohibitsBKcastling = castleKAvailable;
-				move.prohibitsBQcastling = castleQAvailable;
-				addBlackIfValid(board, move, moves, lookup);
-			}
-		}
-
-		// Castling moves.
-		if (sq == squares::e8 && board.getPiece(squares::f8) == pieces::none &&
-			board.getPiece(squares::g8) == pieces::none && castleKAvailable &&
-			!isSquareReachableByWhite(board, squares::f8, lookup.fSqL) &&
-			!isSquareReachableByWhite(board, squares::e8, lookup.fSqL) &&
-			!(lookup.tFilter == TypeFilter::CaptAndPromot))
+		if (board.getTurn() == pieces::Color::WHITE)
 		{
-			assert(board.getPiece(squares::h8) == pieces::bR);
-			Move move = createRegularSilentMove(board, sq, squares::g8);
-			move.prohibitsBKcastling = castleKAvailable;
-			move.prohibitsBQcastling = castleQAvailable;
-			addBlackIfValid(board, move, moves, lookup);
+			getMoves<pieces::Color::WHITE, tFilter, lFilter>(board, moves);
 		}
-
-		if (sq == squares::e8 && board.getPiece(squares::b8) == pieces::none &&
-			board.getPiece(squares::c8) == pieces::none && board.getPiece(squares::d8) == pieces::none
-			&& castleQAvailable && !isSquareReachableByWhite(board, squares::d8, lookup.fSqL) &&
-			!isSquareReachableByWhite(board, squares::e8, lookup.fSqL) &&
-			!(lookup.tFilter == TypeFilter::CaptAndPromot))
+		else
 		{
-			assert(board.getPiece(squares::a8) == pieces::bR);
-			Move move = createRegularSilentMove(board, sq, squares::c8);
-			move.prohibitsBKcastling = castleKAvailable;
-			move.prohibitsBQcastling = castleQAvailable;
-			addBlackIfValid(board, move, moves, lookup);
+			getMoves<pieces::Color::BLACK, tFilter, lFilter>(board, moves);
 		}
 	}
 
-	void addWhitePawnMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
+	// Counts the strictly legal moves of the color, giving the same number as getMoves(), but
+	// without creating any moves. The target squares of each piece are counted at once by a
+	// popcount, and promotions count as four moves.
+	template<pieces::Color color>
+	size_t countLegalMoves(const BoardState& board)
 	{
-		assert(board.getTurn() == pieces::Color::WHITE);
-		assert(board.getPiece(sq) == pieces::wP);
-		assert(ranks::toRank(sq) <= 6); // A pawn should never be at the last rank, ready to move.
-		const Rank rank = ranks::toRank(sq);
+		using namespace bitboards;
+		constexpr Piece offset = getPieceOffset(color);
 
-		// Single pawn advance.
-		const Square singleAdvanceSq = sq + 8;
-		if (board.getPiece(singleAdvanceSq) == pieces::none)
-		{
-			if (rank == 6) // Pawn promotion.
-			{
-				addWhitePawnAdvanceWithPromotions(board, sq, singleAdvanceSq, moves, lookup);
-			}
-			else if (!(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				addWhiteIfValid(board, createRegularSilentMove(
-					board, sq, singleAdvanceSq), moves, lookup);
-			}
-				
+		Lookup lookup;
+		initLegalityMasks<color>(board, lookup);
 
-			// Double pawn advance.
-			const Square doubleAdvanceSq = sq + 16;
-			if (rank == 1 && board.getPiece(doubleAdvanceSq) == pieces::none
-				&& !(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				Move move = createRegularSilentMove(board, sq, doubleAdvanceSq);
-				move.enPassantCreatedSquare = singleAdvanceSq; // One square behind the pawn.
-				addWhiteIfValid(board, move, moves, lookup);
-			}
-		}
+		const Bitboard occupied = board.getOccupiedBitboard();
+		const Bitboard targets = ~board.getColorBitboard(color);
+		size_t num = popCount(getKingAttacks(lookup.kingSq) & targets &
+			getLegalKingTargetMask<color, LegalityFilter::StrictlyLegal>(board, lookup.kingSq));
+		num += canCastleKingSide<color>(board) + canCastleQueenSide<color>(board);
 
-		// Pawn captures.
-		for (const Square captureSq : lookup.fSqL.getWhitePawnCaptureSquares()[sq])
+		if (lookup.checkMask == empty)
 		{
-			const Piece other = board.getPiece(captureSq);
-			if (EngineUtilities::isBlack(other))
-			{
-				if (rank == 6)
-				{
-					addWhitePawnCaptureWithPromotions(board, sq, captureSq, moves, lookup);
-				}
-				else
-				{
-					addWhiteIfValid(board,
-						createWhiteRegularCapturingMove(board, sq, captureSq), moves, lookup);
-				}
-			}
-			else if (captureSq == board.getEnPassantSquare())
-			{
-				assert(board.getPiece(captureSq - 8) == pieces::bP);
-				addWhiteIfValid(board, Move(pieces::wP, sq,
-					captureSq, captureSq, pieces::bP, captureSq - 8), moves, lookup);
-			}
+			// Double check, only the king can move.
+			return num;
 		}
-	}
 
-	void addBlackPawnMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		assert(board.getTurn() == pieces::Color::BLACK);
-		assert(board.getPiece(sq) == pieces::bP);
-		assert(ranks::toRank(sq) >= 1); // A pawn should never be at the last rank, ready to move.
-
-		const Rank rank = ranks::toRank(sq);
-
-		// Single pawn advance.
-		const Square singleAdvanceSq = sq - 8;
-		if (board.getPiece(singleAdvanceSq) == pieces::none)
+		// A pinned knight can never move.
+		for (Bitboard knights = board.getPieceBitboard(offset + pieces::wN) & ~lookup.pinned;
+			knights;)
 		{
-			if (rank == 1) // Pawn promotion.
-			{
-				addBlackPawnAdvanceWithPromotions(board, sq, singleAdvanceSq, moves, lookup);
-			}
-			else if(!(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				addBlackIfValid(board, createRegularSilentMove(
-					board, sq, singleAdvanceSq), moves, lookup);
-			}
+			num += popCount(getKnightAttacks(popLsb(knights)) & targets & lookup.checkMask);
+		}
 
+		const Bitboard queens = board.getPieceBitboard(offset + pieces::wQ);
+		for (Bitboard diagonals = board.getPieceBitboard(offset + pieces::wB) | queens; diagonals;)
+		{
+			const Square sq = popLsb(diagonals);
+			num += popCount(getBishopAttacks(sq, occupied) & targets & getLegalTargetMask(sq, lookup));
+		}
 
-			// Double pawn advance.
-			const Square doubleAdvanceSq = sq - 16;
-			if (rank == 6 && board.getPiece(doubleAdvanceSq) == pieces::none
-				&& !(lookup.tFilter == TypeFilter::CaptAndPromot))
-			{
-				Move move = createRegularSilentMove(board, sq, doubleAdvanceSq);
-				move.enPassantCreatedSquare = singleAdvanceSq; // One square behind the pawn.
-				addBlackIfValid(board, move, moves, lookup);
-			}
+		for (Bitboard straights = board.getPieceBitboard(offset + pieces::wR) | queens; straights;)
+		{
+			const Square sq = popLsb(straights);
+			num += popCount(getRookAttacks(sq, occupied) & targets & getLegalTargetMask(sq, lookup));
 		}
 
-		// Pawn captures.
-		for (const Square captureSq : lookup.fSqL.getBlackPawnCaptureSquares()[sq])
+		const Bitboard pawns = board.getPieceBitboard(offset + pieces::wP);
+		const Bitboard enemies = board.getColorBitboard(getOtherColor(color));
+		constexpr Square advance = color == pieces::Color::WHITE ? 8 : -8;
+		for (Bitboard remaining = pawns; remaining;)
 		{
-			const Piece other = board.getPiece(captureSq);
-			if (EngineUtilities::isWhite(other))
+			const Square sq = popLsb(remaining);
+			const Rank rank = getRelativeRank(color, ranks::toRank(sq));
+			Bitboard pawnTargets = getPawnAttacks<color>(sq) & enemies;
+			const Bitboard singleAdvance = toBitboard(sq + advance);
+			if (!(occupied & singleAdvance))
 			{
-				if (rank == 1)
-				{
-					addBlackPawnCaptureWithPromotions(board, sq, captureSq, moves, lookup);
-				}
-				else
+				pawnTargets |= singleAdvance;
+				if (rank == ranks::rank2 && !(occupied & toBitboard(sq + 2 * advance)))
 				{
-					addBlackIfValid(board,
-						createBlackRegularCapturingMove(board, sq, captureSq), moves, lookup);
+					pawnTargets |= toBitboard(sq + 2 * advance);
 				}
 			}
-			else if (captureSq == board.getEnPassantSquare())
-			{
-				assert(board.getPiece(captureSq + 8) == pieces::wP);
-				addBlackIfValid(board, Move(pieces::bP, sq, captureSq,
-					captureSq, pieces::wP, captureSq + 8), moves, lookup);
-			}
-		}
-	}
-
-	void addWhiteBishopMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH8(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA8(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH1(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA1(), moves, lookup);
-	}
-
-	void addBlackBishopMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH8(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA8(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH1(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA1(), moves, lookup);
-	}
-
-	void addWhiteKnightMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addWhiteRegularNonSweepMoves(board, sq, lookup.fSqL.getknightReachableSquares(),
-			moves, lookup);
-	}
-
-	void addBlackKnightMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addBlackRegularNonSweepMoves(board, sq, lookup.fSqL.getknightReachableSquares(),
-			moves, lookup);
-	}
-
-	void addWhiteRookMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addWhiteRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMin(), moves, lookup);
-		addWhiteRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMax(), moves, lookup);
-		addWhiteRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMin(), moves, lookup);
-		addWhiteRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMax(), moves, lookup);
-	}
-
-	void addBlackRookMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addBlackRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMin(), moves, lookup);
-		addBlackRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMax(), moves, lookup);
-		addBlackRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMin(), moves, lookup);
-		addBlackRookSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMax(), moves, lookup);
-	}
-
-	void addWhiteQueenMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH8(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA8(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH1(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA1(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMin(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMax(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMin(), moves, lookup);
-		addWhiteRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMax(), moves, lookup);
-	}
-
-	void addBlackQueenMoves(BoardState& board, Square sq, const Lookup& lookup,
-		std::vector<Move>& moves)
-	{
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH8(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA8(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsH1(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getDiagTowardsA1(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMin(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsRankMax(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMin(), moves, lookup);
-		addBlackRegularSweepMoves(board, sq, lookup.fSqL.getstraightTowardsFileMax(), moves, lookup);
-	}
-
-	std::vector<Move> getLegalWhiteMoves(BoardState& board, const FastSqLookup& fastSqLookup,
-		const TypeFilter& tFilter = TypeFilter::All,
-		const LegalityFilter& lFilter = LegalityFilter::StrictlyLegal)
-	{
-		static constexpr size_t probableMax = 80;
-		std::vector<Move> moves;
-		moves.reserve(probableMax);
 
-		Lookup lookup(fastSqLookup);
-		lookup.movingSideInCheckPreMove = lFilter == LegalityFilter::StrictlyLegal ?
-			isWhiteInCheck(board, lookup.fSqL) : false;
-		lookup.tFilter = tFilter;
-		lookup.lFilter = lFilter;
-
-		for (Square sq = squares::a1; sq < squares::num; sq++)
-		{
-			assert(EngineUtilities::isValidPiece(board.getPiece(sq)));
-			assert(EngineUtilities::isNonNoneSquare(sq));
-
-			switch (board.getPiece(sq))
-			{ 
-				case pieces::wP:
-					addWhitePawnMoves(board, sq, lookup, moves);
-					break;
-				case pieces::wN:
-					addWhiteKnightMoves(board, sq, lookup, moves);
-					break;
-				case pieces::wB:
-					addWhiteBishopMoves(board, sq, lookup, moves);
-					break;
-				case pieces::wR:
-					addWhiteRookMoves(board, sq, lookup, moves);
-					break;
-				case pieces::wQ:
-					addWhiteQueenMoves(board, sq, lookup, moves);
-					break;
-				case pieces::wK:
-					addWhiteKingMoves(board, sq, lookup, moves);
-					break;
-			}
+			const int8_t numPawnMoves = popCount(pawnTargets & getLegalTargetMask(sq, lookup));
+			num += rank == ranks::rank7 ? 4 * numPawnMoves : numPawnMoves;
 		}
 
-		return moves;
-	}
-
-	std::vector<Move> getLegalBlackMoves(BoardState& board, const FastSqLookup& fastSqLookup,
-		const TypeFilter& tFilter = TypeFilter::All,
-		const LegalityFilter& lFilter = LegalityFilter::StrictlyLegal)
-	{
-		static constexpr size_t probableMax = 80;
-		std::vector<Move> moves;
-		moves.reserve(probableMax);
-
-		Lookup lookup(fastSqLookup);
-		lookup.movingSideInCheckPreMove = lFilter == LegalityFilter::StrictlyLegal ?
-			isBlackInCheck(board, lookup.fSqL) : false;
-		lookup.tFilter = tFilter;
-		lookup.lFilter = lFilter;
-
-		for (Square sq = squares::a1; sq < squares::num; sq++)
+		const Square eSq = board.getEnPassantSquare();
+		if (eSq != squares::none)
 		{
-			assert(EngineUtilities::isValidPiece(board.getPiece(sq)));
-			assert(EngineUtilities::isNonNoneSquare(sq));
-
-			switch (board.getPiece(sq))
+			// It is not an error that the other color pawn captures are used here.
+			for (Bitboard capturers = pawns & getPawnAttacks<getOtherColor(color)>(eSq); capturers;)
 			{
-				case pieces::bP:
-					addBlackPawnMoves(board, sq, lookup, moves);
-					break;
-				case pieces::bN:
-					addBlackKnightMoves(board, sq, lookup, moves);
-					break;
-				case pieces::bB:
-					addBlackBishopMoves(board, sq, lookup, moves);
-					break;
-				case pieces::bR:
-					addBlackRookMoves(board, sq, lookup, moves);
-					break;
-				case pieces::bQ:
-					addBlackQueenMoves(board, sq, lookup, moves);
-					break;
-				case pieces::bK:
-					addBlackKingMoves(board, sq, lookup, moves);
-					break;
+				num += isEnPassantCaptureLegal<color, LegalityFilter::StrictlyLegal>(board,
+					popLsb(capturers), eSq, lookup);
 			}
 		}
 
-		return moves;
+		return num;
 	}
 
-	bool isCastlingMove(const Move& move)
+	// Checks if a move that was not generated for this position (e.g. a move from the
+	// transposition table, which may come from another position with the same hash) is legal.
+	// Only the moves of the moving piece are generated.
+	template<pieces::Color color>
+	bool isLegalMove(const BoardState& board, const Move& move)
 	{
-		if (move.movingPiece != pieces::wK && move.movingPiece != pieces::bK)
-		{
-			return false;
-		}
-
-		if (files::toFile(move.fromSquare) != files::fileE)
+		using namespace bitboards;
+		constexpr TypeFilter all = TypeFilter::All;
+		constexpr LegalityFilter legal = LegalityFilter::StrictlyLegal;
+		const Square sq = move.getFromSquare();
+		const Piece piece = board.getPiece(sq);
+		if (piece == pieces::none ||
+			EngineUtilities::isWhite(piece) != (color == pieces::Color::WHITE))
 		{
 			return false;
 		}
 
-		const File toFile = files::toFile(move.toSquare);
-		if (toFile != files::fileC && toFile != files::fileG)
+		Lookup lookup;
+		initLegalityMasks<color>(board, lookup);
+		MoveList moves;
+		const Bitboard occupied = board.getOccupiedBitboard();
+		switch (piece - getPieceOffset(color))
 		{
-			return false;
+			case pieces::wP: addPawnMoves<color, all, legal>(board, sq, lookup, moves); break;
+			case pieces::wK: addKingMoves<color, all, legal>(board, sq, moves); break;
+			case pieces::wN: addRegularMoves<color, all>(board, sq,
+				getKnightAttacks(sq) & getLegalTargetMask(sq, lookup), moves); break;
+			case pieces::wB: addRegularMoves<color, all>(board, sq,
+				getBishopAttacks(sq, occupied) & getLegalTargetMask(sq, lookup), moves); break;
+			case pieces::wR: addRegularMoves<color, all>(board, sq,
+				getRookAttacks(sq, occupied) & getLegalTargetMask(sq, lookup), moves); break;
+			case pieces::wQ: addRegularMoves<color, all>(board, sq,
+				getQueenAttacks(sq, occupied) & getLegalTargetMask(sq, lookup), moves); break;
 		}
 
-		return true;
+		return std::find(moves.begin(), moves.end(), move) != moves.end();
 	}
 
 	hceEngine::ChessMove moveToChessMove(const Move& move, BoardState& board, Score staticEvaluation)
 	{
 		hceEngine::ChessMove cm;
+		if (!move.isSet())
+		{
+			// No move was found, e.g. since there are no legal moves.
+			cm.type = hceEngine::MoveType::None;
+			return cm;
+		}
 
 		// Normalize the score so that 1.0 represents the value of a single pawn.
 		cm.positionEvaluation = 
@@ -1082,13 +699,26 @@ namespace moveGenerationHelpers
 			cm.positionEvaluation = -cm.positionEvaluation;
 		}
 
-		cm.fromSquare = squares::squareToStr(move.fromSquare);
-		cm.toSquare = squares::squareToStr(move.toSquare);
-		cm.movingPiece = pieces::pieceToStr(move.movingPiece);
-		cm.capturedPiece = move.capturedPiece == pieces::none ?
-			"" : pieces::pieceToStr(move.capturedPiece);
-		cm.pawnPromotionPiece = move.pawnPromotionPiece == pieces::none ?
-			"" : pieces::pieceToStr(move.pawnPromotionPiece);
+		// The move only holds the squares, the pieces are found on the board.
+		const Square fromSquare = move.getFromSquare();
+		const Square toSquare = move.getToSquare();
+		const Piece movingPiece = board.getPiece(fromSquare);
+		Piece capturedPiece = pieces::none;
+		if (move.isEnPassantCapture())
+		{
+			capturedPiece = board.getTurn() == pieces::Color::WHITE ? pieces::bP : pieces::wP;
+		}
+		else if (move.isCapture())
+		{
+			capturedPiece = board.getPiece(toSquare);
+		}
+
+		cm.fromSquare = squares::squareToStr(fromSquare);
+		cm.toSquare = squares::squareToStr(toSquare);
+		cm.movingPiece = pieces::pieceToStr(movingPiece);
+		cm.capturedPiece = capturedPiece == pieces::none ? "" : pieces::pieceToStr(capturedPiece);
+		cm.pawnPromotionPiece = move.isPromotion() ?
+			pieces::pieceToStr(move.getPromotionPiece(board.getTurn())) : "";
 
 		// Set postMoveFEN.
 		board.makeMove(move);
@@ -1096,28 +726,25 @@ namespace moveGenerationHelpers
 		board.unmakeMove(move);
 
 		// Set the move type.
-		if (move.pawnPromotionPiece != pieces::none)
+		if (move.isPromotion())
 		{
-			cm.type = move.capturedPiece == pieces::none ?
-				hceEngine::MoveType::PawnPromotionSilent : hceEngine::MoveType::PawnPromotionCapture;
+			cm.type = move.isCapture() ?
+				hceEngine::MoveType::PawnPromotionCapture : hceEngine::MoveType::PawnPromotionSilent;
 		}
-		else if (move.capturedPiece != pieces::none && move.toSquare != move.capturedSquare)
+		else if (move.isEnPassantCapture())
 		{
 			cm.type = hceEngine::MoveType::EnPassantCapture;
 		}
-		else if (isCastlingMove(move))
+		else if (move.isCastling())
 		{
 			cm.type = hceEngine::MoveType::Castling;
 		}
-		else if (move.capturedPiece != pieces::none)
+		else if (move.isCapture())
 		{
 			cm.type = hceEngine::MoveType::Capture;
 		}
 		else
 		{
-			assert(move.capturedPiece == pieces::none);
-			assert(move.pawnPromotionPiece == pieces::none);
-			assert(move.capturedSquare == squares::none || move.capturedSquare == move.toSquare);
 			cm.type = hceEngine::MoveType::Silent;
 		}
 
@@ -1140,7 +767,8 @@ hceEngine::LegalMovesCollection Engine::getLegalMoves(const std::string& FEN) co
 		return legalMoves;
 	}
 
-	std::vector<Move> moves = getLegalMoves(board);
+	MoveList moves;
+	getLegalMoves(board, moves);
 	for (const auto& move : moves)
 	{
 		legalMoves.moves.push_back(moveToChessMove(move, board, 0));
@@ -1156,43 +784,62 @@ hceEngine::LegalMovesCollection Engine::getLegalMoves(const std::string& FEN) co
 	// No legal moves exists.
 	if (board.getTurn() == pieces::Color::WHITE)
 	{
-		legalMoves.state = isWhiteInCheck(board, fastSqLookup) ?
+		legalMoves.state = isInCheck(board) ?
 			hceEngine::PlayState::BlackWins : hceEngine::PlayState::Draw;
 	}
 	else
 	{
-		{
-			legalMoves.state = isBlackInCheck(board, fastSqLookup) ?
-				hceEngine::PlayState::WhiteWins : hceEngine::PlayState::Draw;
-		}
+		legalMoves.state = isInCheck(board) ?
+			hceEngine::PlayState::WhiteWins : hceEngine::PlayState::Draw;
 	}
 
 	return legalMoves;
 }
 
-std::vector<Move> Engine::getLegalMoves(BoardState& board) const
+void Engine::getLegalMoves(BoardState& board, MoveList& moves) const
 {
-	if (board.getTurn() == pieces::Color::WHITE)
-	{
-		return moveGenerationHelpers::getLegalWhiteMoves(board, fastSqLookup);
-	}
-	else
-	{
-		return moveGenerationHelpers::getLegalBlackMoves(board, fastSqLookup);
-	}
+	using namespace moveGenerationHelpers;
+	getMovesOfMovingSide<TypeFilter::All>(board, moves);
 }
 
+size_t Engine::countLegalMoves(const BoardState& board) const
+{
+	const size_t numMoves = board.getTurn() == pieces::Color::WHITE ?
+		moveGenerationHelpers::countLegalMoves<pieces::Color::WHITE>(board) :
+		moveGenerationHelpers::countLegalMoves<pieces::Color::BLACK>(board);
+
+#ifndef NDEBUG
+	MoveList moves;
+	BoardState boardCopy = board;
+	getLegalMoves(boardCopy, moves);
+	assert(moves.size() == numMoves);
+#endif
+
+	return numMoves;
+}
 
 namespace moveCountHelpers
 {
-	size_t countMovesRecursive(const Engine& engine, BoardState& board, Depth depth)
+	// The table is optional (may be nullptr).
+	size_t countMovesRecursive(const Engine& engine, BoardState& board, Depth depth,
+		PerftTable* table)
 	{
 		if (depth == 1)
 		{
-			return engine.getLegalMoves(board).size();
+			// Most of the moves are counted here, at the last ply, so no moves are created.
+			return engine.countLegalMoves(board);
+		}
+
+		if (table != nullptr)
+		{
+			if (const auto numMoves = table->find(board.getHash(), depth))
+			{
+				return *numMoves;
+			}
 		}
 
-		const auto moves = engine.getLegalMoves(board);
+		MoveList moves;
+		engine.getLegalMoves(board, moves);
 		size_t num = 0;
 		for (const auto& move : moves)
 		{
@@ -1202,25 +849,140 @@ namespace moveCountHelpers
 
 			board.makeMove(move);
 			assert(board.isValid());
-			num += countMovesRecursive(engine, board, depth - 1);
+			num += countMovesRecursive(engine, board, depth - 1, table);
 			assert(board.isValid());
 			board.unmakeMove(move);
 			assert(board.isValid());
 
 			assert(board == boardPreMove);
 		}
+
+		if (table != nullptr)
+		{
+			table->store(board.getHash(), depth, num);
+		}
+
 		return num;
 	}
 
+	// A subtree of the move count, reached from the root by the root move and (if set) the reply.
+	struct CountTask
+	{
+		size_t rootMoveIndex = 0;
+		Move rootMove;
+		Move reply;
+		size_t numMoves = 0;
+	};
+
+	// Splits the tree below the root moves into tasks, at depth 2 if the tree is deep enough to
+	// give the threads enough (and small enough) tasks to balance the work between them.
+	std::vector<CountTask> createCountTasks(const Engine& engine, BoardState& board,
+		const MoveList& rootMoves, Depth depth)
+	{
+		std::vector<CountTask> tasks;
+		for (size_t i = 0; i < rootMoves.size(); i++)
+		{
+			if (depth < 3)
+			{
+				tasks.push_back(CountTask{i, rootMoves[i], Move()});
+				continue;
+			}
+
+			board.makeMove(rootMoves[i]);
+			MoveList replies;
+			engine.getLegalMoves(board, replies);
+			for (const Move& reply : replies)
+			{
+				tasks.push_back(CountTask{i, rootMoves[i], reply});
+			}
+
+			board.unmakeMove(rootMoves[i]);
+		}
+
+		return tasks;
+	}
+
+	void countTaskMoves(const Engine& engine, BoardState& board, CountTask& task, Depth depth,
+		PerftTable* table)
+	{
+		board.makeMove(task.rootMove);
+		if (task.reply.isSet())
+		{
+			board.makeMove(task.reply);
+			task.numMoves = countMovesRecursive(engine, board, depth - 2, table);
+			board.unmakeMove(task.reply);
+		}
+		else
+		{
+			task.numMoves = depth > 1 ? countMovesRecursive(engine, board, depth - 1, table) : 1;
+		}
+
+		board.unmakeMove(task.rootMove);
+	}
+
+	// Returns the number of moves below each of the root moves (in the same order). The threads
+	// take the next unclaimed task until there are none left, so a thread that finishes its tasks
+	// early simply takes over more of the remaining work.
+	std::vector<size_t> countMovesPerRootMove(const Engine& engine, BoardState& board,
+		const MoveList& rootMoves, Depth depth, uint32_t numThreads, PerftTable* table)
+	{
+		std::vector<CountTask> tasks = createCountTasks(engine, board, rootMoves, depth);
+		std::atomic<size_t> nextTask = 0;
+		auto worker = [&engine, &tasks, &nextTask, depth, table](BoardState threadBoard) {
+			for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+			{
+				countTaskMoves(engine, threadBoard, tasks[i], depth, table);
+			}
+		};
+
+		std::vector<std::thread> helpers;
+		for (uint32_t i = 1; i < numThreads; i++)
+		{
+			helpers.emplace_back(worker, board);
+		}
+
+		worker(board);
+		for (std::thread& helper : helpers)
+		{
+			helper.join();
+		}
+
+		std::vector<size_t> numMoves(rootMoves.size(), 0);
+		for (const CountTask& task : tasks)
+		{
+			numMoves[task.rootMoveIndex] += task.numMoves;
+		}
+
+		return numMoves;
+	}
+
 	struct BestMoveData
 	{
 		Move bestMove;
-		searchHelpers::tp::MoveID bestMoveID;
 		Score bestScore = searchHelpers::minusInf;
 	};
 }
 
-std::optional<size_t> Engine::getNumLegalMoves(const std::string& FEN, Depth depth) const
+std::optional<size_t> Engine::getNumLegalMoves(const std::string& FEN, Depth depth,
+	uint32_t numThreads, size_t hashSizeMB) const
+{
+	const auto movesPerMove = getNumLegalMovesPerMove(FEN, depth, numThreads, hashSizeMB);
+	if (!movesPerMove)
+	{
+		return {};
+	}
+
+	size_t num = 0;
+	for (const hceEngine::MoveCount& moveCount : *movesPerMove)
+	{
+		num += moveCount.numLegalMoves;
+	}
+
+	return num;
+}
+
+std::optional<std::vector<hceEngine::MoveCount>> Engine::getNumLegalMovesPerMove(
+	const std::string& FEN, Depth depth, uint32_t numThreads, size_t hashSizeMB) const
 {
 	if (depth <= 0)
 	{
@@ -1228,13 +990,46 @@ std::optional<size_t> Engine::getNumLegalMoves(const std::string& FEN, Depth dep
 		return {};
 	}
 
+	if (numThreads <= 0)
+	{
+		EngineUtilities::logE("getNumLegalMoves failed, number of threads must be at least 1.");
+		return {};
+	}
+
 	BoardState board;
 	if (!board.initFromFEN(FEN))
 	{
 		return {};
 	}
 
-	return moveCountHelpers::countMovesRecursive(*this, board, depth);
+	// The counts never go stale, so the table is kept for the next call if the size is the same.
+	std::shared_ptr<PerftTable> table;
+	if (hashSizeMB > 0)
+	{
+		std::lock_guard<std::mutex> lock(perftTableMutex);
+		if (perftTable == nullptr || perftTable->getSizeMB() != hashSizeMB)
+		{
+			perftTable = std::make_shared<PerftTable>(hashSizeMB);
+		}
+
+		table = perftTable;
+	}
+
+	MoveList rootMoves;
+	getLegalMoves(board, rootMoves);
+	const std::vector<size_t> numMoves = moveCountHelpers::countMovesPerRootMove(*this, board,
+		rootMoves, depth, numThreads, table.get());
+
+	std::vector<hceEngine::MoveCount> movesPerMove;
+	for (size_t i = 0; i < rootMoves.size(); i++)
+	{
+		hceEngine::MoveCount moveCount;
+		moveCount.move = moveGenerationHelpers::moveToChessMove(rootMoves[i], board, 0);
+		moveCount.numLegalMoves = numMoves[i];
+		movesPerMove.push_back(moveCount);
+	}
+
+	return movesPerMove;
 }
 
 hceEngine::StaticEvaluationResult Engine::evaluateStatic(const std::string& FEN) const
@@ -1246,7 +1041,7 @@ hceEngine::StaticEvaluationResult Engine::evaluateStatic(const std::string& FEN)
 		return hceEngine::StaticEvaluationResult::Invalid;
 	}
 
-	const Score score = BoardEvaluator::getStaticEvaluation(board, fastSqLookup);
+	const Score score = BoardEvaluator::getStaticEvaluation(board, pawnHashTable);
 	if (board.getTurn() == pieces::Color::WHITE)
 	{
 		if (score < 0) { return hceEngine::StaticEvaluationResult::BlackBetter; }
@@ -1262,7 +1057,7 @@ hceEngine::StaticEvaluationResult Engine::evaluateStatic(const std::string& FEN)
 }
 
 hceEngine::SearchResult Engine::getBestMove(const std::string& FEN, Depth depth,
-	int32_t timeoutMilliSeconds) const
+	int32_t timeoutMilliSeconds, uint32_t numThreads) const
 {
 	hceEngine::SearchResult searchResult;
 
@@ -1273,7 +1068,14 @@ hceEngine::SearchResult Engine::getBestMove(const std::string& FEN, Depth depth,
 		return searchResult;
 	}
 
-	BoardState board(true);
+	if (numThreads <= 0)
+	{
+		EngineUtilities::logE("getBestMove failed, number of threads must be at least 1.");
+		searchResult.move.type = hceEngine::MoveType::Invalid;
+		return searchResult;
+	}
+
+	BoardState board;
 	if (!board.initFromFEN(FEN))
 	{
 		EngineUtilities::logE("getBestMove failed, invalid FEN.");
@@ -1281,53 +1083,165 @@ hceEngine::SearchResult Engine::getBestMove(const std::string& FEN, Depth depth,
 		return searchResult;
 	}
 
+	if (analysisCache.isOpen())
+	{
+		// The root is always searched with a full window, so a root result is always exact.
+		namespace tp = searchHelpers::tp;
+		const std::optional<tp::Element> cached = analysisCache.find(board.getHash());
+		if (cached.has_value() && cached->type == tp::exact && cached->depth >= depth &&
+			cached->bestMove.isSet() && isLegalMove(board, cached->bestMove))
+		{
+			searchResult.move = moveGenerationHelpers::moveToChessMove(
+				cached->bestMove, board, cached->score);
+			searchResult.engineInfo.depthsCompletelyCovered = cached->depth;
+			searchResult.engineInfo.maxDepthVisited = cached->depth;
+			return searchResult;
+		}
+	}
+
 	hceCommon::Stopwatch stopWatch;
-	searchHelpers::SearchInfo info;
-	moveCountHelpers::BestMoveData bestMoveDataLastDepth;
-	
 	stopWatch.start();
-	Depth currentDepth = 1;
-	auto moves = getLegalMoves(board);
+
+	transpositionTable.allocate();
+	transpositionTable.newSearch();
+	board.setTranspositionTable(&transpositionTable);
+
+	// Lazy SMP: the helper threads search the same position as the main thread, each on its own
+	// copy of the board, and only communicate through the shared transposition table. Every
+	// other helper starts one depth ahead so that the threads do not all search the same nodes.
+	std::atomic<bool> stop = false;
+	std::vector<searchHelpers::SearchInfo> infos(numThreads);
+	std::vector<RootSearchResult> results(numThreads);
+	std::vector<std::thread> helpers;
+	for (uint32_t i = 0; i < numThreads; i++)
+	{
+		infos[i].stop = &stop;
+	}
+
+	for (uint32_t i = 1; i < numThreads; i++)
+	{
+		helpers.emplace_back([this, board, depth, i, &infos, &results]() mutable {
+			const Depth startDepth = std::min<Depth>(depth, 1 + (i % 2));
+			results[i] = searchRoot(board, startDepth, depth,
+				std::numeric_limits<int32_t>::max(), nullptr, infos[i]);
+		});
+	}
+
+	// The main thread is the only one keeping track of the time, and stops the helpers when done.
+	results[0] = searchRoot(board, 1, depth, timeoutMilliSeconds, &stopWatch, infos[0]);
+	stop = true;
+	for (std::thread& helper : helpers)
+	{
+		helper.join();
+	}
+
+	// Use the deepest completed search, prefer the main thread if several are equally deep.
+	size_t bestIndex = 0;
+	for (size_t i = 1; i < results.size(); i++)
+	{
+		if (results[i].depthsCompleted > results[bestIndex].depthsCompleted)
+		{
+			bestIndex = i;
+		}
+	}
+
+	const RootSearchResult& result = results[bestIndex];
+	if (analysisCache.isOpen() && result.depthsCompleted >= AnalysisCache::minDepth &&
+		result.bestMove.isSet())
+	{
+		namespace tp = searchHelpers::tp;
+		analysisCache.store(board.getHash(),
+			tp::Element{result.bestScore, result.depthsCompleted, tp::exact, result.bestMove});
+	}
+
+	searchResult.move = moveGenerationHelpers::moveToChessMove(
+		result.bestMove, board, result.bestScore);
+	searchResult.engineInfo.depthsCompletelyCovered = result.depthsCompleted;
+	size_t evalCacheLookups = 0;
+	size_t evalCacheHits = 0;
+	hceEngine::TranspositionTableInfo& ttInfo = searchResult.engineInfo.transpositionTable;
+	for (const searchHelpers::SearchInfo& info : infos)
+	{
+		ttInfo.probes += info.ttStats.probes;
+		ttInfo.hits += info.ttStats.hits;
+		ttInfo.usableHits += info.ttStats.usableHits;
+		ttInfo.cutoffs += info.ttStats.cutoffs;
+		ttInfo.stores += info.ttStats.stores;
+		ttInfo.replacements += info.ttStats.replacements;
+		ttInfo.illegalTTMoves += info.ttStats.illegalTTMoves;
+		searchResult.engineInfo.nodesVisited += info.nodesVisited;
+		evalCacheLookups += info.evalCacheLookups;
+		evalCacheHits += info.evalCacheHits;
+		searchResult.engineInfo.maxDepthVisited = std::max(searchResult.engineInfo.maxDepthVisited,
+			(size_t)result.depthsCompleted + info.quiescenceMaxDepth);
+	}
+
+	ttInfo.hashfull = transpositionTable.getHashfull();
+	if (evalCacheLookups > 0)
+	{
+		searchResult.engineInfo.evalCacheHitRate =
+			static_cast<float>(evalCacheHits) / static_cast<float>(evalCacheLookups);
+	}
+
+	return searchResult;
+}
+
+Engine::RootSearchResult Engine::searchRoot(BoardState& board, Depth startDepth, Depth depth,
+	int32_t timeoutMilliSeconds, hceCommon::Stopwatch* stopWatch,
+	searchHelpers::SearchInfo& info) const
+{
+	RootSearchResult result;
+	info.timeoutMilliSeconds = timeoutMilliSeconds;
+	moveCountHelpers::BestMoveData bestMoveDataLastDepth;
+	Depth currentDepth = startDepth;
+	MoveList moves;
+	getLegalMoves(board, moves);
+	// assert(dbgTestLegalMoveGeneration(board, moves)); /*Uncomment for testing*/
 	bool timeOut = false;
 	while (currentDepth <= depth && !timeOut)
 	{
 		moveCountHelpers::BestMoveData bestMoveDataCurrDepth;
 		Score alpha = searchHelpers::minusInf;
 		static constexpr Score beta = searchHelpers::plusInf;
-		if (bestMoveDataLastDepth.bestMoveID.isSet())
+		if (bestMoveDataLastDepth.bestMove.isSet())
 		{
-			setStaticEvalAndSortMoves(board, moves, bestMoveDataLastDepth.bestMoveID);
+			setStaticEvalAndSortMoves(board, moves, bestMoveDataLastDepth.bestMove);
 		}
 		else
 		{
 			setStaticEvalAndSortMoves(board, moves);
 		}
 		
-		for (const Move& m : moves)
+		for (size_t i = 0; i < moves.size(); i++)
 		{
-			if (stopWatch.getMilliseconds() >= timeoutMilliSeconds)
+			if (searchHelpers::shouldStop(info))
 			{
 				timeOut = true;
 				break;
 			}
 
+			const Move& m = moves[i];
 			board.makeMove(m);
 			info.nodesVisited++;
-			const int32_t score = -alphaBeta(
-				board, -beta, -alpha, currentDepth-1, m.staticEval, info);
+			const int32_t score = -alphaBeta(board, -beta, -alpha, currentDepth - 1, 1, info);
+			board.unmakeMove(m);
+			if (searchHelpers::shouldStop(info))
+			{
+				// The score of an interrupted search can not be trusted.
+				timeOut = true;
+				break;
+			}
+
 			if (score > bestMoveDataCurrDepth.bestScore)
 			{
 				bestMoveDataCurrDepth.bestScore = score;
 				bestMoveDataCurrDepth.bestMove = m;
-				bestMoveDataCurrDepth.bestMoveID = m.toMoveID();
 			}
 
 			if (score > alpha)
 			{
 				alpha = score;
 			}
-
-			board.unmakeMove(m);
 		}
 
 		if (timeOut)
@@ -1343,8 +1257,13 @@ hceEngine::SearchResult Engine::getBestMove(const std::string& FEN, Depth depth,
 		}
 
 		bestMoveDataLastDepth = bestMoveDataCurrDepth;
+		result.depthsCompleted = currentDepth;
 		currentDepth++;
 
+		// There is now a move to fall back on, so from here on the search may be interrupted
+		// (even in the middle of a depth) when the time is up.
+		info.stopWatch = stopWatch;
+
 		if (bestMoveDataCurrDepth.bestScore >= searchHelpers::plusInf)
 		{
 			// Winning move found.
@@ -1352,15 +1271,12 @@ hceEngine::SearchResult Engine::getBestMove(const std::string& FEN, Depth depth,
 		}
 
 		// Only attempt next depth if we have at least half the time left.
-		timeOut = stopWatch.getMilliseconds() > (timeoutMilliSeconds / 2);
+		timeOut = stopWatch != nullptr && stopWatch->getMilliseconds() > (timeoutMilliSeconds / 2);
 	}
 
-	searchResult.move = moveGenerationHelpers::moveToChessMove(
-		bestMoveDataLastDepth.bestMove, board, bestMoveDataLastDepth.bestScore);
-	searchResult.engineInfo.depthsCompletelyCovered = currentDepth - 1;
-	searchResult.engineInfo.maxDepthVisited = (size_t)(currentDepth - 1) + info.quiescenceMaxDepth;
-	searchResult.engineInfo.nodesVisited = info.nodesVisited;
-	return searchResult;
+	result.bestMove = bestMoveDataLastDepth.bestMove;
+	result.bestScore = bestMoveDataLastDepth.bestScore;
+	return result;
 }
 
 hceEngine::SearchResult Engine::getBestMoveMiniMax(const std::string& FEN, Depth depth) const
@@ -1385,7 +1301,9 @@ hceEngine::SearchResult Engine::getBestMoveMiniMax(const std::string& FEN, Depth
 	searchHelpers::SearchInfo info;
 	Move bestMove;
 	Score bestScore = searchHelpers::minusInf;
-	for (const Move& m : getLegalMoves(board))
+	MoveList moves;
+	getLegalMoves(board, moves);
+	for (const Move& m : moves)
 	{
 		board.makeMove(m);
 		info.nodesVisited++;
@@ -1442,7 +1360,9 @@ hceEngine::SearchResult Engine::getWorstMoveMiniMax(const std::string& FEN, Dept
 	searchHelpers::SearchInfo info;
 	Move worstMove;
 	Score worstScore = searchHelpers::plusInf;
-	for (const Move& m : getLegalMoves(board))
+	MoveList moves;
+	getLegalMoves(board, moves);
+	for (const Move& m : moves)
 	{
 		board.makeMove(m);
 		info.nodesVisited++;
@@ -1463,58 +1383,110 @@ hceEngine::SearchResult Engine::getWorstMoveMiniMax(const std::string& FEN, Dept
 	return searchResult;
 }
 
-std::vector<Move> Engine::getCaptureAndPromotionMoves(BoardState& board) const
+void Engine::clearHash()
 {
-	using namespace moveGenerationHelpers;
-	if (board.getTurn() == pieces::Color::WHITE)
+	transpositionTable.clear();
+	pawnHashTable.clear();
+	evalCache.clear();
+	std::lock_guard<std::mutex> lock(perftTableMutex);
+	perftTable.reset();
+}
+
+void Engine::setHashSizeMB(size_t sizeMB)
+{
+	if (sizeMB <= 0)
 	{
-		return getLegalWhiteMoves(board, fastSqLookup, TypeFilter::CaptAndPromot);
+		EngineUtilities::logE("setHashSizeMB failed, the size must be at least 1MB.");
+		return;
 	}
-	else
+
+	transpositionTable.resize(sizeMB);
+}
+
+bool Engine::openAnalysisCache(const std::string& path, size_t sizeMB)
+{
+	if (sizeMB <= 0)
 	{
-		return getLegalBlackMoves(board, fastSqLookup, TypeFilter::CaptAndPromot);
+		EngineUtilities::logE("openAnalysisCache failed, the size must be at least 1MB.");
+		return false;
 	}
+
+	return analysisCache.open(path, sizeMB);
 }
 
-std::vector<Move> Engine::getPseudoLegalMoves(BoardState& board) const
+void Engine::closeAnalysisCache()
+{
+	analysisCache.close();
+}
+
+void Engine::getCaptureAndPromotionMoves(BoardState& board, MoveList& moves) const
 {
 	using namespace moveGenerationHelpers;
-	if (board.getTurn() == pieces::Color::WHITE)
-	{
-		return getLegalWhiteMoves(board, fastSqLookup, TypeFilter::All, LegalityFilter::PseudoLegal);
-	}
-	else
-	{
-		return getLegalBlackMoves(board, fastSqLookup, TypeFilter::All, LegalityFilter::PseudoLegal);
-	}
+	getMovesOfMovingSide<TypeFilter::CaptAndPromot>(board, moves);
+}
+
+void Engine::getQuietMoves(BoardState& board, MoveList& moves) const
+{
+	using namespace moveGenerationHelpers;
+	getMovesOfMovingSide<TypeFilter::Quiet>(board, moves);
+}
+
+bool Engine::isLegalMove(const BoardState& board, const Move& move) const
+{
+	return board.getTurn() == pieces::Color::WHITE ?
+		moveGenerationHelpers::isLegalMove<pieces::Color::WHITE>(board, move) :
+		moveGenerationHelpers::isLegalMove<pieces::Color::BLACK>(board, move);
 }
 
-bool Engine::dbgTestPseudoLegalMoveGeneration(BoardState& board,
-	const std::vector<Move>& pseudoLegalMoves, bool wasInCheckPreMove) const
+void Engine::getPseudoLegalMoves(BoardState& board, MoveList& moves) const
 {
-	int32_t numLegal = 0;
+	using namespace moveGenerationHelpers;
+	getMovesOfMovingSide<TypeFilter::All, LegalityFilter::PseudoLegal>(board, moves);
+}
+
+bool Engine::dbgTestLegalMoveGeneration(BoardState& board, const MoveList& legalMoves) const
+{
+	MoveList pseudoLegalMoves;
+	getPseudoLegalMoves(board, pseudoLegalMoves);
+	size_t numLegal = 0;
 	for (const auto& pseudoLegalMove : pseudoLegalMoves)
 	{
-		if (!moveGenerationHelpers::doesMoveCauseMovingSideCheck(
-			board, fastSqLookup, pseudoLegalMove, wasInCheckPreMove))
+		if (!moveGenerationHelpers::doesMoveCauseMovingSideCheck(board, pseudoLegalMove))
 		{
 			numLegal++;
 		}
 	}
 
-	return numLegal == getLegalMoves(board).size();
+	return numLegal == legalMoves.size();
+}
+
+Score Engine::getStaticEvaluation(const BoardState& board, searchHelpers::SearchInfo& info) const
+{
+	info.evalCacheLookups++;
+	if (const auto cachedScore = evalCache.find(board.getHash()))
+	{
+		info.evalCacheHits++;
+		assert(*cachedScore ==
+			BoardEvaluator::getStaticEvaluation(board, pawnHashTable));
+		return *cachedScore;
+	}
+
+	const Score score = BoardEvaluator::getStaticEvaluation(board, pawnHashTable);
+	evalCache.store(board.getHash(), score);
+	return score;
 }
 
 Score Engine::negaMax(BoardState& board, Depth depth, searchHelpers::SearchInfo& info) const
 {
 	if (depth <= 0)
 	{
-		return BoardEvaluator::getStaticEvaluation(board, fastSqLookup);
+		return BoardEvaluator::getStaticEvaluation(board, pawnHashTable);
 	}
 
 	Score bestScore = searchHelpers::minusInf;
-	const auto moves = getLegalMoves(board);
-	if (moves.size() == 0 && !moveGenerationHelpers::isInCheck(board, fastSqLookup))
+	MoveList moves;
+	getLegalMoves(board, moves);
+	if (moves.size() == 0 && !moveGenerationHelpers::isInCheck(board))
 	{
 		// Stalemate detected.
 		return 0;
@@ -1535,21 +1507,50 @@ Score Engine::negaMax(BoardState& board, Depth depth, searchHelpers::SearchInfo&
 	return bestScore;
 }
 
-Score Engine::alphaBeta(BoardState& board, Score alpha, Score beta, Depth depth,
-	Score staticEval, searchHelpers::SearchInfo& info) const
+Score Engine::alphaBeta(BoardState& board, Score alpha, Score beta, Depth depth, Depth ply,
+	searchHelpers::SearchInfo& info) const
 {
 	using namespace searchHelpers;
 	using namespace moveGenerationHelpers;
 
+	if (shouldStop(info))
+	{
+		return 0;
+	}
+
 	const Score alphaOrig = alpha;
-	const tp::Element* elem = board.findTranspositionElement();
-	if (elem != nullptr)
+	std::optional<tp::Element> elem = board.findTranspositionElement();
+	if constexpr (countTTStats)
+	{
+		info.ttStats.probes++;
+		info.ttStats.hits += elem.has_value();
+		info.ttStats.usableHits += elem.has_value() && elem->depth >= depth;
+	}
+
+	// The analysis cache is only probed where the transposition table can not help, since the
+	// probe may have to read from the disk.
+	if (depth >= AnalysisCache::minDepth && analysisCache.isOpen() &&
+		(!elem.has_value() || elem->depth < depth))
+	{
+		const std::optional<tp::Element> cached = analysisCache.find(board.getHash());
+		if (cached.has_value() && (!elem.has_value() || cached->depth > elem->depth))
+		{
+			elem = cached;
+		}
+	}
+
+	if (elem.has_value())
 	{
 		if (elem->depth >= depth)
 		{
 			switch (elem->type)
 			{
 				case tp::exact:
+					if constexpr (countTTStats)
+					{
+						info.ttStats.cutoffs++;
+					}
+
 					return elem->score;
 				case tp::lower:
 					alpha = std::max(alpha, elem->score);
@@ -1561,6 +1562,11 @@ Score Engine::alphaBeta(BoardState& board, Score alpha, Score beta, Depth depth,
 
 			if (alpha >= beta)
 			{
+				if constexpr (countTTStats)
+				{
+					info.ttStats.cutoffs++;
+				}
+
 				return elem->score;
 			}
 		}
@@ -1568,53 +1574,45 @@ Score Engine::alphaBeta(BoardState& board, Score alpha, Score beta, Depth depth,
 
 	if (depth <= 0)
 	{
-		return alphaBetaQuiescence(board, alpha, beta, 0, staticEval, info);
+		return alphaBetaQuiescence(board, alpha, beta, 0, getStaticEvaluation(board, info), info);
 	}
 
 	Score bestScore = minusInf;
-	tp::MoveID bestMoveId;
-	auto moves = getPseudoLegalMoves(board);
-	const bool inCheckPreMove = moves.size() > 0 ? isInCheck(board, fastSqLookup) : false;
-	// assert(dbgTestPseudoLegalMoveGeneration(board, moves, inCheckPreMove)); /*Uncomment for testing*/
-	if (elem != nullptr && elem->bestMove.isSet())
-	{
-		assert(elem->bestMove.to != squares::none);
-		setStaticEvalUsingDeltaAndSortMoves(board, moves, staticEval, elem->bestMove);
-	}
-	else
-	{
-		setStaticEvalUsingDeltaAndSortMoves(board, moves, staticEval);
-	}
-	
-	bool legalMoveExists = false; // moves.size() cannot be used since it is pseudo-legal moves.
-	for (const Move& move : moves)
+	Move bestMove;
+	bool legalMoveExists = false;
+	MovePicker picker(*this, board, elem.has_value() ? elem->bestMove : Move(), info, ply);
+	for (Move move = picker.next(); move.isSet(); move = picker.next())
 	{
-		if (doesMoveCauseMovingSideCheck(board, fastSqLookup, move, inCheckPreMove))
-		{
-			// Filter out non-legal moves (thouse causing moveing side checks).
-			continue;
-		}
-
 		legalMoveExists = true;
 		board.makeMove(move);
 		info.nodesVisited++;
-		const Score score = -alphaBeta(
-			board, -beta, -alpha, depth - 1, move.staticEval, info);
+		const Score score = -alphaBeta(board, -beta, -alpha, depth - 1, ply + 1, info);
 		board.unmakeMove(move);
+		if (shouldStop(info))
+		{
+			// The search was interrupted, the result must not end up in the transposition table.
+			return 0;
+		}
+
 		if (score > bestScore)
 		{
 			bestScore = score;
-			bestMoveId = move.toMoveID();
+			bestMove = move;
 		}
 
 		alpha = std::max(alpha, score);
 		if (alpha >= beta)
 		{
+			if (!move.isCapture() && !move.isPromotion())
+			{
+				storeKiller(info, ply, move);
+			}
+
 			break;
 		}
 	}
 
-	if (!legalMoveExists && !moveGenerationHelpers::isInCheck(board, fastSqLookup))
+	if (!legalMoveExists && !isInCheck(board))
 	{
 		// Stalemate detected.
 		return 0;
@@ -1625,7 +1623,19 @@ Score Engine::alphaBeta(BoardState& board, Score alpha, Score beta, Depth depth,
 	else if (bestScore >= beta) type = tp::lower;
 	else type = tp::exact;
 
-	board.addTranspositionElement(tp::Element{bestScore, depth, type, bestMoveId});
+	const tp::Element newElem{bestScore, depth, type, bestMove};
+	const bool replaced = board.addTranspositionElement(newElem);
+	if constexpr (countTTStats)
+	{
+		info.ttStats.stores++;
+		info.ttStats.replacements += replaced;
+	}
+
+	if (depth >= AnalysisCache::minDepth && analysisCache.isOpen())
+	{
+		analysisCache.store(board.getHash(), newElem);
+	}
+
 	return bestScore;
 }
 
@@ -1638,9 +1648,14 @@ Score Engine::alphaBetaQuiescence(BoardState& board, Score alpha, Score beta,
 		info.quiescenceMaxDepth = currDepth;
 	}
 
+	if (shouldStop(info))
+	{
+		return 0;
+	}
+
 	// Optimization: the staticEval was calculated one node above this during move sorting, so we
 	// don't have to call the evaluation function here again.
-	assert(staticEval == BoardEvaluator::getStaticEvaluation(board, fastSqLookup));
+	assert(staticEval == BoardEvaluator::getStaticEvaluation(board, pawnHashTable));
 	if (staticEval >= beta)
 	{
 		return beta;
@@ -1651,16 +1666,23 @@ Score Engine::alphaBetaQuiescence(BoardState& board, Score alpha, Score beta,
 		alpha = staticEval;
 	}
 
-	auto moves = getCaptureAndPromotionMoves(board);
-	setStaticEvalAndSortMoves(board, moves);
-	for (const Move& move : moves)
+	MoveList moves;
+	getCaptureAndPromotionMoves(board, moves);
+	setStaticEvalUsingDeltaAndSortMoves(board, moves, staticEval);
+	for (size_t i = 0; i < moves.size(); i++)
 	{
-		assert(move.capturedPiece != pieces::none || move.pawnPromotionPiece != pieces::none);
+		const Move& move = moves[i];
+		assert(move.isCapture() || move.isPromotion());
 		board.makeMove(move);
 		info.nodesVisited++;
 		const Score score = -alphaBetaQuiescence(board, -beta, -alpha, currDepth + 1,
-			move.staticEval, info);
+			moves.getStaticEval(i), info);
 		board.unmakeMove(move);
+		if (shouldStop(info))
+		{
+			return 0;
+		}
+
 		if (score >= beta)
 		{
 			// Prune.
@@ -1676,21 +1698,18 @@ Score Engine::alphaBetaQuiescence(BoardState& board, Score alpha, Score beta,
 	return alpha;
 }
 
-void Engine::setStaticEvalAndSortMoves(BoardState& board, std::vector<Move>& moves) const
+void Engine::setStaticEvalAndSortMoves(BoardState& board, MoveList& moves) const
 {
-	for (Move& move : moves)
+	if (moves.size() == 0)
 	{
-		board.makeMove(move);
-		assert(board.isValid());
-		move.staticEval = BoardEvaluator::getStaticEvaluation(board, fastSqLookup);
-		board.unmakeMove(move);
+		return;
 	}
 
-	assert(board.isValid());
-	std::sort(moves.begin(), moves.end());
+	setStaticEvalUsingDeltaAndSortMoves(board, moves,
+		BoardEvaluator::getStaticEvaluation(board, pawnHashTable));
 }
 
-void Engine::setStaticEvalAndSortMoves(BoardState& board, std::vector<Move>& moves, const searchHelpers::tp::MoveID& bestMove) const
+void Engine::setStaticEvalAndSortMoves(BoardState& board, MoveList& moves, const Move& bestMove) const
 {
 	if (moves.size() <= 0)
 	{
@@ -1703,21 +1722,21 @@ void Engine::setStaticEvalAndSortMoves(BoardState& board, std::vector<Move>& mov
 	setKnownBestMoveFirst(moves, bestMove);
 }
 
-void Engine::setKnownBestMoveFirst(std::vector<Move>& moves, const searchHelpers::tp::MoveID& bestMove) const
+void Engine::setKnownBestMoveFirst(MoveList& moves, const Move& bestMove) const
 {
 	assert(bestMove.isSet());
 
-	for (int32_t i = 0; i < moves.size(); i++)
+	for (size_t i = 0; i < moves.size(); i++)
 	{
-		if (bestMove.from == moves[i].fromSquare && bestMove.to == moves[i].toSquare)
+		if (moves[i] == bestMove)
 		{
-			std::iter_swap(moves.begin(), moves.begin() + i);
+			moves.moveToFront(i);
 			return;
 		}
 	}
 }
 
-void Engine::setStaticEvalUsingDeltaAndSortMoves(BoardState& board, std::vector<Move>& moves,
+void Engine::setStaticEvalUsingDeltaAndSortMoves(BoardState& board, MoveList& moves,
 	Score staticEval) const
 {
 	if (moves.size() == 0)
@@ -1725,43 +1744,21 @@ void Engine::setStaticEvalUsingDeltaAndSortMoves(BoardState& board, std::vector<
 		return;
 	}
 
-	const auto preMoveInfo = BoardEvaluator::createPreMoveInfo(board);
-	for (Move& move : moves)
+	const auto preMoveInfo = BoardEvaluator::createPreMoveInfo(board, pawnHashTable);
+	for (size_t i = 0; i < moves.size(); i++)
 	{
-		if (BoardEvaluator::canUseGetStaticEvaluationDelta(move))
-		{
-			move.staticEval = -BoardEvaluator::getStaticEvaluationDelta(
-				board, move, preMoveInfo, fastSqLookup) - staticEval;
+		const Move& move = moves[i];
+		moves.setStaticEval(i, -BoardEvaluator::getStaticEvaluationDelta(
+			board, move, preMoveInfo, pawnHashTable) - staticEval);
 
 #ifndef NDEBUG
-			board.makeMove(move);
-			assert(move.staticEval == BoardEvaluator::getStaticEvaluation(board, fastSqLookup));
-			board.unmakeMove(move);
+		board.makeMove(move);
+		assert(moves.getStaticEval(i) ==
+			BoardEvaluator::getStaticEvaluation(board, pawnHashTable));
+		board.unmakeMove(move);
 #endif
-		}
-		else
-		{
-			board.makeMove(move);
-			assert(board.isValid());
-			move.staticEval = BoardEvaluator::getStaticEvaluation(board, fastSqLookup);
-			board.unmakeMove(move);
-		}
-	}
-	assert(board.isValid());
-	std::sort(moves.begin(), moves.end());
-}
-
-void Engine::setStaticEvalUsingDeltaAndSortMoves(BoardState& board, std::vector<Move>& moves,
-	Score staticEval, const searchHelpers::tp::MoveID& bestMove) const
-{
-	if (moves.size() == 0)
-	{
-		return;
 	}
 
-	// Do the regular sorting.
-	setStaticEvalUsingDeltaAndSortMoves(board, moves, staticEval);
-
-	// Finally, we override the default sort and put the known bestMove at the beginning.
-	setKnownBestMoveFirst(moves, bestMove);
+	assert(board.isValid());
+	moves.sortByStaticEval();
 }
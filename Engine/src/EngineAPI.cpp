@@ -18,17 +18,24 @@ EngineAPI::~EngineAPI()
 }
 
 std::optional<size_t> EngineAPI::getNumLegalMoves(
-    const std::string& FEN, uint8_t depth) const
+    const std::string& FEN, uint8_t depth, uint32_t numThreads, size_t hashSizeMB) const
 {
     assert(engine != nullptr);
-    return engine->getNumLegalMoves(FEN, depth);
+    return engine->getNumLegalMoves(FEN, depth, numThreads, hashSizeMB);
+}
+
+std::optional<std::vector<MoveCount>> EngineAPI::getNumLegalMovesPerMove(
+    const std::string& FEN, uint8_t depth, uint32_t numThreads, size_t hashSizeMB) const
+{
+    assert(engine != nullptr);
+    return engine->getNumLegalMovesPerMove(FEN, depth, numThreads, hashSizeMB);
 }
 
 SearchResult hceEngine::EngineAPI::getBestMove(const std::string& FEN, uint8_t depth,
-    int32_t timeoutMilliSeconds) const
+    int32_t timeoutMilliSeconds, uint32_t numThreads) const
 {
     assert(engine != nullptr);
-    return engine->getBestMove(FEN, depth, timeoutMilliSeconds);
+    return engine->getBestMove(FEN, depth, timeoutMilliSeconds, numThreads);
 }
 
 SearchResult EngineAPI::getBestMoveMiniMax(const std::string& FEN, uint8_t depth) const
@@ -54,3 +61,27 @@ StaticEvaluationResult EngineAPI::evaluateStatic(const std::string& FEN) const
     assert(engine != nullptr);
     return engine->evaluateStatic(FEN);
 }
+
+void EngineAPI::clearHash()
+{
+    assert(engine != nullptr);
+    engine->clearHash();
+}
+
+void EngineAPI::setHashSizeMB(size_t sizeMB)
+{
+    assert(engine != nullptr);
+    engine->setHashSizeMB(sizeMB);
+}
+
+bool EngineAPI::openAnalysisCache(const std::string& path, size_t sizeMB)
+{
+    assert(engine != nullptr);
+    return engine->openAnalysisCache(path, sizeMB);
+}
+
+void EngineAPI::closeAnalysisCache()
+{
+    assert(engine != nullptr);
+    engine->closeAnalysisCache();
+}
@@ -0,0 +1,48 @@
+#include "PrivateInclude/EvalCache.h"
+
+namespace
+{
+	// The lowest bits of an entry hold the score, the rest are the upper bits of the hash.
+	static constexpr uint64_t scoreMask = 0xFFFF;
+	static constexpr size_t minNumEntries = scoreMask + 1;
+}
+
+EvalCache::EvalCache(size_t inNumEntries)
+{
+	numEntries = minNumEntries;
+	while (numEntries * 2 <= inNumEntries)
+	{
+		numEntries *= 2;
+	}
+
+	entries = std::make_unique<std::atomic<uint64_t>[]>(numEntries);
+	entryMask = numEntries - 1;
+	clear();
+}
+
+std::optional<Score> EvalCache::find(Hash64 hash) const
+{
+	// An empty entry is all zeros and never a hit. The (very unlikely) entry that is all zeros
+	// for real is simply never found.
+	const uint64_t data = entries[hash & entryMask].load(std::memory_order_relaxed);
+	if (((data ^ hash) & ~scoreMask) == 0 && data != 0)
+	{
+		return static_cast<Score>(static_cast<uint16_t>(data));
+	}
+
+	return {};
+}
+
+void EvalCache::store(Hash64 hash, Score score)
+{
+	const uint64_t data = (hash & ~scoreMask) | static_cast<uint16_t>(score);
+	entries[hash & entryMask].store(data, std::memory_order_relaxed);
+}
+
+void EvalCache::clear()
+{
+	for (size_t i = 0; i < numEntries; i++)
+	{
+		entries[i].store(0, std::memory_order_relaxed);
+	}
+}
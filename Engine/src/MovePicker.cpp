@@ -0,0 +1,156 @@
+#include "PrivateInclude/MovePicker.h"
+
+#include "PrivateInclude/Engine.h"
+#include "PrivateInclude/BoardState.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	// Rough piece values, indexed by the piece type (i.e. the white piece), only used for ordering.
+	static constexpr std::array<Score, 6> orderingValues = {
+		10, // King.
+		9, // Queen.
+		5, // Rook.
+		3, // Bishop.
+		3, // Knight.
+		1 // Pawn.
+	};
+
+	Score getOrderingValue(Piece piece)
+	{
+		assert(EngineUtilities::isNonNonePiece(piece));
+		return orderingValues[piece < pieces::bK ? piece : piece - pieces::bK];
+	}
+}
+
+MovePicker::MovePicker(const Engine& inEngine, BoardState& inBoard, const Move& inTTMove,
+	searchHelpers::SearchInfo& inInfo, Depth ply) :
+	engine{inEngine},
+	board{inBoard},
+	info{inInfo},
+	ttMove{inTTMove},
+	killers{inInfo.killers[ply]}
+{
+}
+
+Move MovePicker::next()
+{
+	switch (stage)
+	{
+		case Stage::TTMove:
+			stage = Stage::GenerateCaptures;
+			if (ttMove.isSet() && engine.isLegalMove(board, ttMove))
+			{
+				return ttMove;
+			}
+
+			// The move is not from this position (a hash collision), never hand it out.
+			if constexpr (searchHelpers::countTTStats)
+			{
+				info.ttStats.illegalTTMoves += ttMove.isSet();
+			}
+
+			ttMove = Move();
+			[[fallthrough]];
+
+		case Stage::GenerateCaptures:
+			engine.getCaptureAndPromotionMoves(board, moves);
+			scoreCaptures();
+			index = 0;
+			stage = Stage::Captures;
+			[[fallthrough]];
+
+		case Stage::Captures:
+			while (index < moves.size())
+			{
+				const Move& move = moves[index++];
+				if (move != ttMove)
+				{
+					return move;
+				}
+			}
+
+			index = 0;
+			stage = Stage::Killers;
+			[[fallthrough]];
+
+		case Stage::Killers:
+			while (index < killers.size())
+			{
+				const Move& killer = killers[index++];
+				if (killer.isSet() && killer != ttMove && !killer.isCapture() &&
+					!killer.isPromotion() && engine.isLegalMove(board, killer))
+				{
+					return killer;
+				}
+			}
+
+			stage = Stage::GenerateQuiets;
+			[[fallthrough]];
+
+		case Stage::GenerateQuiets:
+			engine.getQuietMoves(board, moves);
+			if (moves.size() > 0)
+			{
+				const Score staticEval = engine.getStaticEvaluation(board, info);
+				engine.setStaticEvalUsingDeltaAndSortMoves(board, moves, staticEval);
+			}
+
+			index = 0;
+			stage = Stage::Quiets;
+			[[fallthrough]];
+
+		case Stage::Quiets:
+			while (index < moves.size())
+			{
+				const Move& move = moves[index++];
+				if (!isTTMoveOrKiller(move))
+				{
+					return move;
+				}
+			}
+
+			stage = Stage::Done;
+			[[fallthrough]];
+
+		case Stage::Done:
+			return Move();
+	}
+
+	assert(false);
+	return Move();
+}
+
+void MovePicker::scoreCaptures()
+{
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		const Move& move = moves[i];
+		Score score = 0;
+		if (move.isCapture())
+		{
+			// Most valuable victim first, then least valuable attacker.
+			const Piece victim = move.isEnPassantCapture() ? pieces::wP :
+				board.getPiece(move.getToSquare());
+			score = getOrderingValue(victim) * 16 - getOrderingValue(
+				board.getPiece(move.getFromSquare()));
+		}
+
+		if (move.isPromotion())
+		{
+			score += getOrderingValue(move.getPromotionPiece(board.getTurn())) * 16;
+		}
+
+		// The moves are sorted lowest first.
+		moves.setStaticEval(i, -score);
+	}
+
+	moves.sortByStaticEval();
+}
+
+bool MovePicker::isTTMoveOrKiller(const Move& move) const
+{
+	return move == ttMove || std::find(killers.begin(), killers.end(), move) != killers.end();
+}
@@ -0,0 +1,67 @@
+#include "PrivateInclude/PawnHashTable.h"
+
+namespace
+{
+	// Set in the data of all stored entries, so that an empty entry never matches.
+	static constexpr uint64_t validBit = uint64_t(1) << 32;
+
+	uint64_t toData(const PawnHashTable::Element& elem)
+	{
+		return static_cast<uint64_t>(static_cast<uint16_t>(elem.score)) |
+			static_cast<uint64_t>(elem.whiteFiles) << 16 |
+			static_cast<uint64_t>(elem.blackFiles) << 24 |
+			validBit;
+	}
+
+	PawnHashTable::Element toElement(uint64_t data)
+	{
+		PawnHashTable::Element elem;
+		elem.score = static_cast<Score>(static_cast<uint16_t>(data));
+		elem.whiteFiles = static_cast<uint8_t>(data >> 16);
+		elem.blackFiles = static_cast<uint8_t>(data >> 24);
+		return elem;
+	}
+}
+
+PawnHashTable::PawnHashTable(size_t inNumEntries)
+{
+	numEntries = 1;
+	while (numEntries * 2 <= inNumEntries)
+	{
+		numEntries *= 2;
+	}
+
+	entries = std::make_unique<Entry[]>(numEntries);
+	entryMask = numEntries - 1;
+}
+
+std::optional<PawnHashTable::Element> PawnHashTable::find(Hash64 pawnHash) const
+{
+	const Entry& entry = entries[pawnHash & entryMask];
+	const uint64_t data = entry.data.load(std::memory_order_relaxed);
+	const Hash64 key = entry.keyXorData.load(std::memory_order_relaxed) ^ data;
+	if (key == pawnHash && (data & validBit) != 0)
+	{
+		return toElement(data);
+	}
+
+	return {};
+}
+
+void PawnHashTable::store(Hash64 pawnHash, const Element& elem)
+{
+	// Always replace, the table is direct-mapped.
+	Entry& entry = entries[pawnHash & entryMask];
+	const uint64_t data = toData(elem);
+	entry.data.store(data, std::memory_order_relaxed);
+	entry.keyXorData.store(pawnHash ^ data, std::memory_order_relaxed);
+}
+
+void PawnHashTable::clear()
+{
+	for (size_t i = 0; i < numEntries; i++)
+	{
+		entries[i].data.store(0, std::memory_order_relaxed);
+		entries[i].keyXorData.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,71 @@
+#include "PrivateInclude/PerftTable.h"
+
+#include <cassert>
+
+namespace
+{
+	// The depth is kept in the lowest byte of the data, the number of moves in the rest.
+	uint64_t toData(Depth depth, size_t numMoves)
+	{
+		return static_cast<uint64_t>(numMoves) << 8 | depth;
+	}
+
+	Depth getDepth(uint64_t data)
+	{
+		return static_cast<Depth>(data);
+	}
+
+	size_t getNumMoves(uint64_t data)
+	{
+		return static_cast<size_t>(data >> 8);
+	}
+
+	// Note: depth 0 is never stored, so an empty entry (all zeros) is never found.
+	bool isMatch(const std::atomic<uint64_t>& keyXorData, uint64_t data, Hash64 hash, Depth depth)
+	{
+		return (keyXorData.load(std::memory_order_relaxed) ^ data) == hash &&
+			getDepth(data) == depth;
+	}
+}
+
+PerftTable::PerftTable(size_t inSizeMB) : sizeMB{inSizeMB}
+{
+	const size_t maxNumBuckets = (sizeMB * 1024 * 1024) / sizeof(Bucket);
+
+	// Round down to a power of two so that the bucket index can be found using a bitmask.
+	size_t numBuckets = 1;
+	while (numBuckets * 2 <= maxNumBuckets)
+	{
+		numBuckets *= 2;
+	}
+
+	buckets = std::make_unique<Bucket[]>(numBuckets);
+	bucketMask = numBuckets - 1;
+}
+
+std::optional<size_t> PerftTable::find(Hash64 hash, Depth depth) const
+{
+	const Bucket& bucket = getBucket(hash);
+	for (const Entry* entry : {&bucket.depthPreferred, &bucket.alwaysReplace})
+	{
+		const uint64_t data = entry->data.load(std::memory_order_relaxed);
+		if (isMatch(entry->keyXorData, data, hash, depth))
+		{
+			return getNumMoves(data);
+		}
+	}
+
+	return {};
+}
+
+void PerftTable::store(Hash64 hash, Depth depth, size_t numMoves)
+{
+	assert(depth > 0);
+
+	Bucket& bucket = getBucket(hash);
+	const uint64_t data = toData(depth, numMoves);
+	Entry& entry = depth >= getDepth(bucket.depthPreferred.data.load(std::memory_order_relaxed)) ?
+		bucket.depthPreferred : bucket.alwaysReplace;
+	entry.data.store(data, std::memory_order_relaxed);
+	entry.keyXorData.store(hash ^ data, std::memory_order_relaxed);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "SearchHelpers.h"
+
+#include <atomic>
+#include <optional>
+#include <string>
+
+/**
+* Hash table of search results that lives in a memory mapped file, so that the results of deep
+* searches are kept between runs of the program. Opening the file is instant, the pages are only
+* read from disk once they are probed. Just like the TranspositionTable, the table is indexed by
+* the Zobrist hash of the position and each entry is two atomic words (the hash xor:ed with the
+* data, and the data), so it can be shared by concurrently searching threads without locking.
+* A bucket holds a few entries. When it is full, the most shallow entry is replaced, where entries
+* kept from earlier sessions (openings of the file) count as more shallow the older they are, so
+* that old results eventually give way to new ones. The file also holds a fingerprint of the
+* evaluation, a file made by an engine that scores positions differently is cleared when opened.
+* Several processes may use the file at the same time, but only a process that is the only user
+* of the file may create or clear it (see open()).
+* The file format depends on the platform (e.g. its byte order), the file is a cache and not meant
+* to be moved between machines.
+* Only supported on POSIX systems, on other systems open() always fails.
+*/
+class AnalysisCache
+{
+public:
+	// Nodes searched to a smaller depth are cheap to search again, and not worth the disk space.
+	static constexpr Depth minDepth = 4;
+
+	AnalysisCache() = default;
+	~AnalysisCache();
+
+	AnalysisCache(const AnalysisCache&) = delete;
+	AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+	// Maps the file, creating it with a size of (at most) sizeMB megabytes if it does not exist. An
+	// existing file keeps its size, unless it is cleared since it was made by another evaluation.
+	// Returns false if the file could not be used, e.g. if it needs to be cleared but is in use by
+	// another process.
+	bool open(const std::string& path, size_t sizeMB);
+
+	void close();
+
+	bool isOpen() const { return buckets != nullptr; }
+
+	std::optional<searchHelpers::tp::Element> find(Hash64 hash) const;
+
+	// Does not replace a deeper result of the same position stored in the same session.
+	void store(Hash64 hash, const searchHelpers::tp::Element& elem);
+
+private:
+	struct Entry
+	{
+		std::atomic<uint64_t> keyXorData;
+		std::atomic<uint64_t> data;
+	};
+
+	static_assert(sizeof(Entry) == 2 * sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+		"The entries must have the same layout as the plain integers in the file.");
+
+	static constexpr size_t entriesPerBucket = 4;
+
+	struct Bucket
+	{
+		Entry entries[entriesPerBucket];
+	};
+
+	const Bucket& getBucket(Hash64 hash) const { return buckets[hash & bucketMask]; }
+	Bucket& getBucket(Hash64 hash) { return buckets[hash & bucketMask]; }
+
+	// Makes entries that are too old to tell apart by age younger, see the cpp file.
+	void ageEntries();
+
+	// Kept open while the file is mapped, since it holds the lock of the file.
+	int file = -1;
+	void* mapping = nullptr;
+	size_t mappingSize = 0;
+	Bucket* buckets = nullptr;
+	Hash64 bucketMask = 0;
+	uint16_t session = 0;
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "PiecesAndSquares.h"
+
+#include <cstdint>
+#include <array>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// One bit per square, bit 0 is a1 and bit 63 is h8 (same order as the Square type).
+typedef uint64_t Bitboard;
+
+namespace bitboards
+{
+	static constexpr Bitboard empty = 0;
+	static constexpr Bitboard all = ~empty;
+
+	static constexpr Bitboard fileA = 0x0101010101010101;
+	static constexpr Bitboard fileH = fileA << 7;
+
+	static constexpr Bitboard rank1 = 0xFF;
+	static constexpr Bitboard rank2 = rank1 << 8;
+	static constexpr Bitboard rank7 = rank1 << 48;
+	static constexpr Bitboard rank8 = rank1 << 56;
+
+	constexpr Bitboard toBitboard(Square sq)
+	{
+		return Bitboard(1) << sq;
+	}
+
+	inline int8_t popCount(Bitboard bb)
+	{
+#ifdef _MSC_VER
+		return static_cast<int8_t>(__popcnt64(bb));
+#else
+		return static_cast<int8_t>(__builtin_popcountll(bb));
+#endif
+	}
+
+	// The bitboard must not be empty.
+	inline Square lsb(Bitboard bb)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, bb);
+		return static_cast<Square>(index);
+#else
+		return static_cast<Square>(__builtin_ctzll(bb));
+#endif
+	}
+
+	// Returns the least significant square and removes it from the bitboard, which must not be empty.
+	inline Square popLsb(Bitboard& bb)
+	{
+		const Square sq = lsb(bb);
+		bb &= bb - 1;
+		return sq;
+	}
+
+	/**
+	* Everything needed to look up the attacks of a sliding piece on a single square. The relevant
+	* blockers (mask) are multiplied by the magic number, and the top bits of the result form an
+	* index into the attacks of that square, see magicValues.
+	*/
+	struct Magic
+	{
+		Bitboard mask = 0;
+		Bitboard magic = 0;
+		uint32_t offset = 0;
+		uint8_t shift = 0;
+
+		uint32_t getIndex(Bitboard occupied) const
+		{
+			return offset + static_cast<uint32_t>(((occupied & mask) * magic) >> shift);
+		}
+	};
+
+	/**
+	* Precomputed attack tables for all pieces. Slow to construct, which is why there is only one
+	* (immutable) instance of it, created at program start and shared by everyone, see attackTables.
+	*/
+	struct AttackTables
+	{
+		AttackTables() noexcept;
+
+		static constexpr size_t rookTableSize = 102400;
+		static constexpr size_t bishopTableSize = 5248;
+
+		std::array<Magic, squares::num> rookMagics;
+		std::array<Magic, squares::num> bishopMagics;
+		std::array<Bitboard, rookTableSize> rookAttacks;
+		std::array<Bitboard, bishopTableSize> bishopAttacks;
+
+		std::array<Bitboard, squares::num> knightAttacks;
+		std::array<Bitboard, squares::num> kingAttacks;
+		std::array<Bitboard, squares::num> whitePawnAttacks;
+		std::array<Bitboard, squares::num> blackPawnAttacks;
+
+		std::array<std::array<Bitboard, squares::num>, squares::num> betweenSquares;
+		std::array<std::array<Bitboard, squares::num>, squares::num> lines;
+	};
+
+	extern const AttackTables attackTables;
+
+	inline Bitboard getRookAttacks(Square sq, Bitboard occupied)
+	{
+		return attackTables.rookAttacks[attackTables.rookMagics[sq].getIndex(occupied)];
+	}
+
+	inline Bitboard getBishopAttacks(Square sq, Bitboard occupied)
+	{
+		return attackTables.bishopAttacks[attackTables.bishopMagics[sq].getIndex(occupied)];
+	}
+
+	inline Bitboard getQueenAttacks(Square sq, Bitboard occupied)
+	{
+		return getRookAttacks(sq, occupied) | getBishopAttacks(sq, occupied);
+	}
+
+	inline Bitboard getKnightAttacks(Square sq)
+	{
+		return attackTables.knightAttacks[sq];
+	}
+
+	// Castling moves are not included.
+	inline Bitboard getKingAttacks(Square sq)
+	{
+		return attackTables.kingAttacks[sq];
+	}
+
+	// The squares a white pawn on sq is able to capture on.
+	inline Bitboard getWhitePawnAttacks(Square sq)
+	{
+		return attackTables.whitePawnAttacks[sq];
+	}
+
+	// The squares a black pawn on sq is able to capture on.
+	inline Bitboard getBlackPawnAttacks(Square sq)
+	{
+		return attackTables.blackPawnAttacks[sq];
+	}
+
+	// The squares strictly between two squares on the same rank, file or diagonal. Empty if the
+	// squares are not aligned.
+	inline Bitboard getBetween(Square sq1, Square sq2)
+	{
+		return attackTables.betweenSquares[sq1][sq2];
+	}
+
+	// The whole rank, file or diagonal (edge to edge) that both squares are on. Empty if the
+	// squares are not aligned.
+	inline Bitboard getLine(Square sq1, Square sq2)
+	{
+		return attackTables.lines[sq1][sq2];
+	}
+}
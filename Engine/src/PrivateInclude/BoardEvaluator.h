@@ -4,29 +4,30 @@
 #include "BoardState.h"
 
 class Move;
-class FastSqLookup;
+class PawnHashTable;
 
 /**
-* The BoardEvaluator enables fast evaluation of a BoardState. Note that the construction of this
-* object is slow, but once it has been constructed the evaluations are very fast. This means that
-* instances of this class should be kept and stored somewhere for repeated use if possible.
+* The BoardEvaluator enables fast evaluation of a BoardState. It has no state of its own (all of its
+* functions are static and its tables are generated at compile time), the only memory an evaluation
+* uses besides the board is the PawnHashTable it is given.
 */
 class BoardEvaluator
 {
 public:
-	static Score getStaticEvaluation(const BoardState& board, const FastSqLookup& lookup);
+	static Score getStaticEvaluation(const BoardState& board, PawnHashTable& pawnHashTable);
 	
+	// The parts of the evaluation of the board before the move that getStaticEvaluationDelta() may
+	// have to compare against. Create it once and use it for all the moves of a position.
 	struct PreMoveInfo
 	{
-		std::array<bool, files::num> movingSidePawnsFileOccupation = { false };
+		Score pawnStructureScore = 0;
+		Score minorPiecesScore = 0;
+		Score kingsScore = 0;
 	};
 
-	// For some moves (NOT all!), the change in board static evaluation score that the move will cause
-	// can be calculated quickly without having to make the move. IMPORTANT: always call the
-	// canUseGetStaticEvaluationDelta() to determine if this function can be used or not for the move. 
-	// If not, then the normal getStaticEvaluation() must be used.
-	// If canUseGetStaticEvaluationDelta() returns true, it is guaranteed that these two options of
-	// getting the static evaluations yiedls the same result but the latter is much faster;
+	// The change in board static evaluation score that the move will cause, calculated without
+	// having to make the move. It is guaranteed that these two options of getting the static
+	// evaluation yield the same result, but the latter is much faster:
 	//
 	// -OPTION 1-
 	// makeMove()
@@ -34,13 +35,12 @@ public:
 	// unmakeMove()
 	//
 	// -OPTION 2-
-	// eval = preMoveEval + getStaticEvaluationDelta()
+	// eval = -(preMoveEval + getStaticEvaluationDelta())
 	//
 	static Score getStaticEvaluationDelta(const BoardState& board, const Move& move,
-		const PreMoveInfo& preMoveInfo, const FastSqLookup& lookup);
-	static bool canUseGetStaticEvaluationDelta(const Move& move);
+		const PreMoveInfo& preMoveInfo, PawnHashTable& pawnHashTable);
 
-	static PreMoveInfo createPreMoveInfo(const BoardState& board);
+	static PreMoveInfo createPreMoveInfo(const BoardState& board, PawnHashTable& pawnHashTable);
 
 	static Score getPawnBaseValue();
 };
@@ -2,19 +2,23 @@
 
 #include "PiecesAndSquares.h"
 #include "HashValues.h"
+#include "Bitboards.h"
+#include "TranspositionTable.h"
 
 #include <string>
 #include <array>
-#include <unordered_map>
+#include <type_traits>
 #include <optional>
+#include <utility>
 
-struct Move;
+class Move;
 
 class BoardState
 {
 public:
+	using PieceBitboards = std::array<Bitboard, pieces::num>;
+
 	BoardState() = default;
-	BoardState(bool reserveTranspositionTable);
 
 	bool operator==(const BoardState& other) const;
 
@@ -23,18 +27,38 @@ public:
 
 	void printBoard() const;
 
+	// Everything needed to take the move back is pushed onto an undo stack in the board, so moves
+	// must be unmade in the reverse order that they were made.
 	void makeMove(const Move& move);
 	void unmakeMove(const Move& move);
 
 	bool isValid() const;
 
+	// The from and to squares of the rook in a castling move, given the king's to square.
+	static std::pair<Square, Square> getCastlingRookSquares(Square kingToSquare);
+
+	// The generate functions compute their values from scratch, only visiting the squares that
+	// have pieces on them (the piece bitboards must be up to date).
 	Hash64 generateHash() const;
 	Hash64 getHash() const { return hash; }
-	void addTranspositionElement(const searchHelpers::tp::Element& elem);
-	size_t getTranspositionTableSize() const { return transpositionTable.size(); }
 
-	// Returns nullptr if the current hash is not in the transpositionTable.
-	const searchHelpers::tp::Element* findTranspositionElement() const;
+	// The part of the hash that comes from the pawns only. Used to look up pawn structure
+	// evaluations, which are the same for all positions with the same pawns.
+	Hash64 generatePawnHash() const;
+	Hash64 getPawnHash() const { return pawnHash; }
+
+	// The material and piece square score of all pieces but the kings, from white's point of view.
+	// Kept up to date by makeMove() and unmakeMove(), see scoringConstants::pieceSquareScores.
+	Score generatePieceSquareScore() const;
+	Score getPieceSquareScore() const { return pieceSquareScore; }
+
+	// The table is not owned by the board, and must outlive it (or be reset to nullptr).
+	void setTranspositionTable(TranspositionTable* table) { transpositionTable = table; }
+	// Returns true if the element of another position was replaced.
+	bool addTranspositionElement(const searchHelpers::tp::Element& elem);
+
+	// Returns an empty optional if the current hash is not in the transpositionTable.
+	std::optional<searchHelpers::tp::Element> findTranspositionElement() const;
 
 	pieces::Color getTurn() const
 	{
@@ -46,24 +70,34 @@ public:
 		return pieces;
 	}
 
-	std::array<Piece, squares::num>& getPieces()
+	Piece getPiece(Square sq) const
 	{
-		return pieces;
+		return pieces[sq];
 	}
 
-	Piece getPiece(Square sq) const
+	Bitboard getPieceBitboard(Piece piece) const
 	{
-		return pieces[sq];
+		return pieceBitboards[piece];
 	}
 
-	const std::unordered_map<char, bool> getCastleAvailability() const
+	const PieceBitboards& getPieceBitboards() const
 	{
-		return casleAvailability;
+		return pieceBitboards;
 	}
 
-	std::unordered_map<char, bool>& getCastleAvailability()
+	Bitboard getColorBitboard(pieces::Color color) const
 	{
-		return casleAvailability;
+		return colorBitboards[static_cast<size_t>(color)];
+	}
+
+	Bitboard getOccupiedBitboard() const
+	{
+		return colorBitboards[0] | colorBitboards[1];
+	}
+
+	CastlingRights getCastlingRights() const
+	{
+		return castlingRights;
 	}
 
 	Square getEnPassantSquare() const
@@ -92,27 +126,42 @@ public:
 	}
 
 private:
-	void makePawnMove(const Move& move);
-	void unmakePawnMove(const Move& move);
-
-	void makeKingMove(const Move& move);
-	void unmakeKingMove(const Move& move);
+	// The state that a move destroys, and that can not be derived from the move itself.
+	struct UndoInfo
+	{
+		Hash64 hash;
+		Piece capturedPiece;
+		Square enPassantSquare;
+		CastlingRights castlingRights;
+	};
 
-	void makeWhiteRookMoveIfCastling(const Move& move);
-	void makeBlackRookMoveIfCastling(const Move& move);
+	// Deeper than any search will go, including the quiescence search.
+	static constexpr size_t maxUndoDepth = 512;
 
-	void unmakeWhiteRookMoveIfCastling(const Move& move);
-	void unmakeBlackRookMoveIfCastling(const Move& move);
+	// Moves the rook of a castling move (back to its corner if undo is set).
+	void moveCastlingRook(Square kingToSquare, bool undo);
 
-	void makeNonSpecializedMove(const Move& move);
-	void unmakeNonSpecializedMove(const Move& move, bool updateHash = true);
+	// Keeps the pieces array, the bitboards, the pawn hash and the piece square score in sync.
+	// Does not touch the (full) hash.
+	void placePiece(Square sq, Piece piece);
+	void clearSquare(Square sq);
+	void initBitboards();
 
 	std::array<Piece, squares::num> pieces = {pieces::none};
-	std::unordered_map<char, bool> casleAvailability;
+	PieceBitboards pieceBitboards = {bitboards::empty};
+	std::array<Bitboard, 2> colorBitboards = {bitboards::empty};
+	CastlingRights castlingRights = castlingRights::none;
 	pieces::Color turn;
 	Square enPassantSquare = squares::none;
 	Square wKingSq = squares::none;
 	Square bKingSq = squares::none;
 	Hash64 hash;
-	std::unordered_map<Hash64, searchHelpers::tp::Element> transpositionTable;
+	Hash64 pawnHash = 0;
+	Score pieceSquareScore = 0;
+	TranspositionTable* transpositionTable = nullptr;
+	std::array<UndoInfo, maxUndoDepth> undoStack;
+	size_t undoStackSize = 0;
 };
+
+// Boards are copied e.g. for each search thread, which should be nothing more than a memcpy.
+static_assert(std::is_trivially_copyable<BoardState>::value, "BoardState must be trivially copyable.");
@@ -2,67 +2,123 @@
 
 #include "Engine/EngineAPIReturnDefinitions.h"
 
-#include "FastSqLookup.h"
 #include "BoardEvaluator.h"
 #include "BoardState.h"
 #include "SearchHelpers.h"
+#include "TranspositionTable.h"
+#include "PawnHashTable.h"
+#include "EvalCache.h"
+#include "PerftTable.h"
+#include "AnalysisCache.h"
+#include "Move.h"
+#include "MoveList.h"
+#include "Common/StopWatch.h"
 
 #include <vector>
 #include <optional>
-
-class Move;
+#include <memory>
+#include <mutex>
 
 class Engine
 {
 public:
 	hceEngine::LegalMovesCollection getLegalMoves(const std::string& FEN) const;
 
-	std::vector<Move> getLegalMoves(BoardState& board) const;
+	void getLegalMoves(BoardState& board, MoveList& moves) const;
+
+	// The same as the size of the getLegalMoves() list, but faster since no moves are created.
+	// Meant for counting, e.g. the leaves of getNumLegalMoves() or the mobility of a position.
+	size_t countLegalMoves(const BoardState& board) const;
 
-	std::optional<size_t> getNumLegalMoves(const std::string& FEN, Depth depth) const;
+	std::optional<size_t> getNumLegalMoves(const std::string& FEN, Depth depth,
+		uint32_t numThreads, size_t hashSizeMB) const;
+
+	std::optional<std::vector<hceEngine::MoveCount>> getNumLegalMovesPerMove(
+		const std::string& FEN, Depth depth, uint32_t numThreads, size_t hashSizeMB) const;
 
 	hceEngine::StaticEvaluationResult evaluateStatic(const std::string& FEN) const;
 
 	hceEngine::SearchResult getBestMove(const std::string& FEN, Depth depth,
-		int32_t timeoutMilliSeconds) const;
+		int32_t timeoutMilliSeconds, uint32_t numThreads) const;
 
 	hceEngine::SearchResult getBestMoveMiniMax(const std::string& FEN, Depth depth) const;
 	hceEngine::SearchResult getWorstMoveMiniMax(const std::string& FEN, Depth depth) const;
 
+	void clearHash();
+
+	void setHashSizeMB(size_t sizeMB);
+
+	bool openAnalysisCache(const std::string& path, size_t sizeMB);
+
+	void closeAnalysisCache();
+
 private:
-	std::vector<Move> getCaptureAndPromotionMoves(BoardState& board) const;
+	// The result of an iterative deepening search from the root position.
+	struct RootSearchResult
+	{
+		Move bestMove;
+		Score bestScore = searchHelpers::minusInf;
+		Depth depthsCompleted = 0;
+	};
+
+	// Iterative deepening from startDepth to depth (inclusive). Only completely searched depths
+	// are part of the result. Without a stopWatch, the search runs until the depth is reached or
+	// the stop flag in the info is raised by someone else.
+	RootSearchResult searchRoot(BoardState& board, Depth startDepth, Depth depth,
+		int32_t timeoutMilliSeconds, hceCommon::Stopwatch* stopWatch,
+		searchHelpers::SearchInfo& info) const;
+
+	friend class MovePicker;
+
+	void getCaptureAndPromotionMoves(BoardState& board, MoveList& moves) const;
+
+	// The moves not included by getCaptureAndPromotionMoves().
+	void getQuietMoves(BoardState& board, MoveList& moves) const;
+
+	// For moves that were not generated for the board, e.g. moves from the transposition table.
+	bool isLegalMove(const BoardState& board, const Move& move) const;
 
 	// Includes moves that causes moving side to in check after the move, i.e. pseudo-legal.
-	std::vector<Move> getPseudoLegalMoves(BoardState& board) const;
+	void getPseudoLegalMoves(BoardState& board, MoveList& moves) const;
 
-	// Convenient tester-functions that checks that the pseudo-legal move generation is correct.
-	// Only to be used in testing situations, e.g. in debug builds.
-	bool dbgTestPseudoLegalMoveGeneration(BoardState& board,
-		const std::vector<Move>& pseudoLegalMoves, bool wasInCheckPreMove) const;
+	// Convenient tester-function that checks that the legal move generation agrees with filtering
+	// the pseudo-legal moves by making them. Only to be used in testing situations, e.g. in debug
+	// builds.
+	bool dbgTestLegalMoveGeneration(BoardState& board, const MoveList& legalMoves) const;
+
+	// The static evaluation of the board, looked up in the evalCache if possible.
+	Score getStaticEvaluation(const BoardState& board, searchHelpers::SearchInfo& info) const;
 
-	
 	Score negaMax(BoardState& board, Depth depth, searchHelpers::SearchInfo& info) const;
 	
-	Score alphaBeta(BoardState& board, Score alpha, Score beta, Depth depth,
-		Score staticEval, searchHelpers::SearchInfo& info) const;
+	Score alphaBeta(BoardState& board, Score alpha, Score beta, Depth depth, Depth ply,
+		searchHelpers::SearchInfo& info) const;
 	
 	Score alphaBetaQuiescence(BoardState& board, Score alpha, Score beta, Depth currDepth,
 		Score staticEval, searchHelpers::SearchInfo& info) const;
 	
-	void setStaticEvalAndSortMoves(BoardState& board, std::vector<Move>& moves) const;
-	void setStaticEvalAndSortMoves(BoardState& board, std::vector<Move>& moves,
-		const searchHelpers::tp::MoveID& bestMove) const;
+	void setStaticEvalAndSortMoves(BoardState& board, MoveList& moves) const;
+	void setStaticEvalAndSortMoves(BoardState& board, MoveList& moves,
+		const Move& bestMove) const;
 
-	void setKnownBestMoveFirst(std::vector<Move>& moves,
-		const searchHelpers::tp::MoveID& bestMove) const;
+	void setKnownBestMoveFirst(MoveList& moves,
+		const Move& bestMove) const;
 	
-	// Tries to use the fast evaluation delta scheme offered by the BoardEvaluator. A valid pre-move
-	// static evaluation score must be provided to use this function!
-	void setStaticEvalUsingDeltaAndSortMoves(BoardState& board, std::vector<Move>& moves,
+	// Uses the fast evaluation delta scheme offered by the BoardEvaluator. A valid pre-move static
+	// evaluation score must be provided to use this function!
+	void setStaticEvalUsingDeltaAndSortMoves(BoardState& board, MoveList& moves,
 		Score staticEval) const;
 
-	void setStaticEvalUsingDeltaAndSortMoves(BoardState& board, std::vector<Move>& moves,
-		Score staticEval, const searchHelpers::tp::MoveID& bestMove) const;
+	// Kept between getBestMove calls so that consecutive searches can reuse previous results.
+	mutable TranspositionTable transpositionTable;
+	mutable PawnHashTable pawnHashTable;
+	mutable EvalCache evalCache;
+
+	// Only created when a move count is asked to use a hash table. Each count holds on to the
+	// table it started with, so that a concurrent count asking for another size can replace it.
+	mutable std::shared_ptr<PerftTable> perftTable;
+	mutable std::mutex perftTableMutex;
 
-	FastSqLookup fastSqLookup;
+	// Unlike the tables above, kept between runs of the program. Only used when opened.
+	mutable AnalysisCache analysisCache;
 };
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "SearchHelpers.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+/**
+* Direct-mapped cache of static evaluations, indexed by the Zobrist hash of the position. The same
+* positions are evaluated again and again, both by each iteration of the iterative deepening and
+* when they are reached through transpositions, and a lookup is much cheaper than an evaluation.
+* Each entry is a single atomic word holding the upper bits of the hash and the score, so the
+* cache can be shared by concurrently searching threads without locking (an entry can never be
+* torn). The lower bits of the hash are implied by the index of the entry.
+*/
+class EvalCache
+{
+public:
+	static constexpr size_t defaultNumEntries = size_t(1) << 17;
+
+	// The number of entries is rounded down to a power of two, and at least 2^16.
+	EvalCache(size_t numEntries = defaultNumEntries);
+
+	// The score is from the point of view of the side to move.
+	std::optional<Score> find(Hash64 hash) const;
+
+	void store(Hash64 hash, Score score);
+
+	void clear();
+
+private:
+	std::unique_ptr<std::atomic<uint64_t>[]> entries;
+	size_t numEntries = 0;
+	Hash64 entryMask = 0;
+};
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "SearchHelpers.h"
 #include "PiecesAndSquares.h"
 
@@ -183,4 +185,36 @@ namespace hashValues
 		0x5340ffa96a8657b0, 0x6463c3631336705d, 0xd5ab751347b3fd3, 0x6c89b8960f1ec427, 0x25f1c1c17e1219c8,
 		0x20530e7b743ce6fa, 0x1514a0af144c9480
 	};
+
+	constexpr int16_t getHashIndex(Square sq, Piece piece)
+	{
+		return sq * pieces::num + piece;
+	}
+
+	constexpr bool isPawn(Piece piece)
+	{
+		return piece == pieces::wP || piece == pieces::bP;
+	}
+
+	// The combined hash value of each combination of castling rights (see castlingRights). Since
+	// xor is its own inverse, castlingValues[oldRights ^ newRights] is the change of the hash
+	// when the rights change.
+	constexpr std::array<Hash64, castlingRights::num> createCastlingValues()
+	{
+		std::array<Hash64, castlingRights::num> castlingValues = {0};
+		for (size_t rights = 0; rights < castlingRights::num; rights++)
+		{
+			for (size_t i = 0; i < 4; i++)
+			{
+				if (rights & (size_t(1) << i))
+				{
+					castlingValues[rights] ^= values[castlingIndexStart + i];
+				}
+			}
+		}
+
+		return castlingValues;
+	}
+
+	static constexpr std::array<Hash64, castlingRights::num> castlingValues = createCastlingValues();
 }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "PiecesAndSquares.h"
+
+#include <cstdint>
+#include <array>
+
+/**
+* Magic numbers used for looking up sliding piece (rook, bishop and queen) attacks, see the
+* bitboards namespace. Each number maps the relevant blocker squares of a square to a unique index
+* in the attack table of that square. The numbers were found by trial and error (random sparse
+* 64-bit numbers) and are only valid together with the blocker masks generated in Bitboards.cpp.
+*/
+namespace magicValues
+{
+	static constexpr std::array<uint64_t, squares::num> rook =
+	{
+		0x208000822810c000, 0x440001000200040, 0x100104020010008, 0x200042200100840,
+		0x4080040080080002, 0x100080201000400, 0x400441002010088, 0x6080008000413500,
+		0x101002040800100, 0x2008802006400880, 0x6002801000200180, 0x2801001080084,
+		0x1002001008200600, 0x400a000410087200, 0x8000800200010080, 0x83000040820900,
+		0x1020218000824000, 0x10484000201000, 0x1c0110041002000, 0x21d00100100a0,
+		0x4080818008000c00, 0x820808002000400, 0x808840001100208, 0x40520010cc0781,
+		0x4000400080208000, 0x42004000c0201000, 0x22008600204011, 0x100100280080080,
+		0x408008080080401, 0x1106008080040002, 0x4c81000500140200, 0x801001020008904c,
+		0x4000400020800080, 0x2008201004400040, 0x8010200080801000, 0x6030008010800805,
+		0xa20800400800801, 0x112000402001008, 0x480244000190, 0x2480288042001405,
+		0x202180c000228010, 0x30004020004000, 0xb020011000818020, 0x800100409010020,
+		0xc12008820060010, 0xa001020040400, 0x44029008040001, 0x4000404400820001,
+		0x40400080002080, 0x2320400880290100, 0x4100801000200480, 0x10c900105a00900,
+		0x20800400080080, 0x20080040080, 0x1008101228010c00, 0x8010080440200,
+		0x426800220110441, 0x49004020108202, 0x4044090a2000a82, 0x4008208d29001001,
+		0xa001004200802, 0x82000410010802, 0x81480201100800c4, 0x100610084002042
+	};
+
+	static constexpr std::array<uint64_t, squares::num> bishop =
+	{
+		0x8020040088104288, 0x8090c01920102, 0x201000a200520400, 0x80080a0020306001,
+		0xd403088010a800, 0x518221110411000, 0x14808809410200, 0x10804042202103,
+		0x401a02092020044, 0x120080810841040, 0x5040e1150c00800a, 0x40400880608,
+		0x216011140080002, 0x8124020104200884, 0x2a843402080405, 0x20a10120900410,
+		0x8404048881080, 0x6880660023c0440, 0x8010400401200, 0x8040804802004000,
+		0x4014026080a01a00, 0x8841001210008400, 0x121005048088400, 0x20140c300b840,
+		0x9408404542800, 0x1940c0820450420, 0x4010010004c80, 0x304010048200880,
+		0x9020024008400, 0x1230022004100, 0xc201240002008412, 0x2068008242102,
+		0x4012201220201200, 0x1000c80826041006, 0x3080804910240, 0x1380800020a00,
+		0x4b0460020020080, 0x802008a01210800, 0x20042c0400286108, 0x4042040008042,
+		0x8000842020000811, 0x2001080884000200, 0x4464402401081004, 0x5000014206202800,
+		0x40401891040200, 0x300a4c1802000020, 0xd09004080062008e, 0x482420400201306,
+		0x804210d008080080, 0x12108201100020, 0x8021201041000, 0x84100042020000,
+		0x201301022088214, 0x800401204030910, 0x202002040800a400, 0x402040400920502,
+		0x6000808410020282, 0x110088848080400, 0x4000000842209000, 0x5000090000208810,
+		0x8120058060085040, 0x800000040468020c, 0x20000a105010a100, 0x84103006088018
+	};
+}
@@ -2,69 +2,87 @@
 
 #include "PiecesAndSquares.h"
 #include "EngineUtilities.h"
-#include "SearchHelpers.h"
 
 #include <cassert>
 
+namespace moveFlags
+{
+	// Bit 2 is set for all captures and bit 3 for all promotions. For promotions, the two lowest
+	// bits hold the promotion piece.
+	static constexpr uint8_t quiet = 0;
+	static constexpr uint8_t doublePawnPush = 1;
+	static constexpr uint8_t kingCastle = 2;
+	static constexpr uint8_t queenCastle = 3;
+	static constexpr uint8_t capture = 4;
+	static constexpr uint8_t enPassantCapture = 5;
+	static constexpr uint8_t knightPromotion = 8;
+	static constexpr uint8_t bishopPromotion = 9;
+	static constexpr uint8_t rookPromotion = 10;
+	static constexpr uint8_t queenPromotion = 11;
+	static constexpr uint8_t knightPromotionCapture = 12;
+	static constexpr uint8_t bishopPromotionCapture = 13;
+	static constexpr uint8_t rookPromotionCapture = 14;
+	static constexpr uint8_t queenPromotionCapture = 15;
+}
+
+/**
+* A move packed into 16 bits: the from square (6 bits), the to square (6 bits) and a set of flags
+* (4 bits, see moveFlags). Everything else that is needed to make or unmake the move (the moving
+* and captured pieces, castling rights, en passant square etc.) is found on the board, which keeps
+* its own undo history (see BoardState::makeMove()).
+*/
 class Move
 {
 public:
 	Move() = default;
 
-	Move(Piece inMovingPiece, Square inFromSquare, Square inToSqaure, Square inPreviousEnPassantSq) :
-		movingPiece{ inMovingPiece },
-		fromSquare{ inFromSquare },
-		toSquare{ inToSqaure },
-		previousEnPassantSquare{ inPreviousEnPassantSq }
+	Move(Square fromSquare, Square toSquare, uint8_t flags = moveFlags::quiet) :
+		data{static_cast<uint16_t>(fromSquare | toSquare << 6 | flags << 12)}
 	{
-		assert(EngineUtilities::isNonNonePiece(inMovingPiece));
-		assert(EngineUtilities::isNonNoneSquare(inFromSquare));
-		assert(EngineUtilities::isNonNoneSquare(inToSqaure));
-		assert(EngineUtilities::isValidSquare(inPreviousEnPassantSq));
-	}
-	
-	Move(Piece inMovingPiece, Square inFromSquare, Square inToSqaure, Square inPreviousEnPassantSq,
-		Piece inCapturedPiece, Square inCapturedSquare) :
-		movingPiece{inMovingPiece},
-		fromSquare{inFromSquare},
-		toSquare{inToSqaure},
-		previousEnPassantSquare{ inPreviousEnPassantSq },
-		capturedPiece{ inCapturedPiece },
-		capturedSquare { inCapturedSquare }
-	{
-		assert(EngineUtilities::isNonNonePiece(inMovingPiece));
-		assert(EngineUtilities::isNonNoneSquare(inFromSquare));
-		assert(EngineUtilities::isNonNoneSquare(inToSqaure));
-		assert(EngineUtilities::isNonNonePiece(inCapturedPiece));
-		assert(EngineUtilities::isNonNoneSquare(inCapturedSquare));
+		assert(EngineUtilities::isNonNoneSquare(fromSquare));
+		assert(EngineUtilities::isNonNoneSquare(toSquare));
+		assert(flags < 16);
 	}
 
-	searchHelpers::tp::MoveID toMoveID() const
+	Square getFromSquare() const { return static_cast<Square>(data & 0x3f); }
+	Square getToSquare() const { return static_cast<Square>((data >> 6) & 0x3f); }
+	uint8_t getFlags() const { return static_cast<uint8_t>(data >> 12); }
+
+	bool isCapture() const { return (getFlags() & moveFlags::capture) != 0; }
+	bool isPromotion() const { return (getFlags() & moveFlags::knightPromotion) != 0; }
+	bool isEnPassantCapture() const { return getFlags() == moveFlags::enPassantCapture; }
+	bool isDoublePawnPush() const { return getFlags() == moveFlags::doublePawnPush; }
+
+	bool isCastling() const
 	{
-		return searchHelpers::tp::MoveID{ fromSquare, toSquare };
+		return getFlags() == moveFlags::kingCastle || getFlags() == moveFlags::queenCastle;
 	}
 
-	bool operator < (const Move& other) const
+	// Only valid for promotions. The color is that of the moving side.
+	Piece getPromotionPiece(pieces::Color color) const
 	{
-		return staticEval < other.staticEval;
+		assert(isPromotion());
+
+		// The flags are ordered N, B, R, Q while the pieces are ordered Q, R, B, N.
+		const Piece piece = static_cast<Piece>(pieces::wN - (getFlags() & 3));
+		return color == pieces::Color::WHITE ? piece : static_cast<Piece>(piece + pieces::bK);
 	}
 
-	Piece movingPiece = pieces::none;	
-	Square fromSquare = squares::none;
-	Square toSquare = squares::none;
-	Piece capturedPiece = pieces::none;
-	Square capturedSquare = squares::none; // Will be same as toSquare except for en passant captures.
+	// A default constructed move is not set. No real move has the same from and to square.
+	bool isSet() const { return data != 0; }
+
+	uint16_t getData() const { return data; }
 
-	// These are needed for pawn promotion or en passant caaptures/creation.
-	Piece pawnPromotionPiece = pieces::none;
-	Square previousEnPassantSquare = squares::none;
-	Square enPassantCreatedSquare = squares::none;
+	static Move fromData(uint16_t data)
+	{
+		Move move;
+		move.data = data;
+		return move;
+	}
 
-	bool prohibitsWKcastling = false; // White king-side.
-	bool prohibitsWQcastling = false; // White queen side.
-	bool prohibitsBKcastling = false; // Black king side.
-	bool prohibitsBQcastling = false; // Black queen side.
+	bool operator==(const Move& other) const { return data == other.data; }
+	bool operator!=(const Move& other) const { return data != other.data; }
 
-	// The static evaluation of the board when this move has been made.
-	Score staticEval = 0;
+private:
+	uint16_t data = 0;
 };
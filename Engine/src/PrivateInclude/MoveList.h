@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Move.h"
+#include "SearchHelpers.h"
+
+#include <cassert>
+#include <algorithm>
+#include <new>
+
+/**
+* A fixed-capacity list of moves, meant to live on the stack (e.g. one per ply of the search) so
+* that move generation never has to allocate memory. The capacity is large enough for any legal
+* chess position (the known maximum is 218 moves). The storage is left uninitialized until moves
+* are added, which means that creating a MoveList costs nothing.
+* Each move has a static evaluation which is used as its sort key. The keys are kept in an array
+* of their own, next to the moves, so that the moves themselves can stay small.
+*/
+class MoveList
+{
+public:
+	static constexpr size_t capacity = 256;
+
+	MoveList() {}
+
+	MoveList(const MoveList& other) : numMoves{other.numMoves}
+	{
+		std::copy(other.begin(), other.end(), begin());
+		std::copy(other.staticEvals, other.staticEvals + numMoves, staticEvals);
+	}
+
+	MoveList& operator=(const MoveList& other)
+	{
+		numMoves = other.numMoves;
+		std::copy(other.begin(), other.end(), begin());
+		std::copy(other.staticEvals, other.staticEvals + numMoves, staticEvals);
+		return *this;
+	}
+
+	void push_back(const Move& move)
+	{
+		assert(numMoves < capacity);
+		new (data() + numMoves) Move(move);
+		numMoves++;
+	}
+
+	void clear() { numMoves = 0; }
+
+	size_t size() const { return numMoves; }
+	bool empty() const { return numMoves == 0; }
+
+	Move& operator[](size_t index)
+	{
+		assert(index < numMoves);
+		return data()[index];
+	}
+
+	const Move& operator[](size_t index) const
+	{
+		assert(index < numMoves);
+		return data()[index];
+	}
+
+	// The static evaluation of the board when the move at index has been made.
+	Score getStaticEval(size_t index) const
+	{
+		assert(index < numMoves);
+		return staticEvals[index];
+	}
+
+	void setStaticEval(size_t index, Score staticEval)
+	{
+		assert(index < numMoves);
+		staticEvals[index] = staticEval;
+	}
+
+	// Sorts the moves by their static evaluation, lowest first. The sort is stable, and since the
+	// lists are short and often close to sorted already, insertion sort is used.
+	void sortByStaticEval()
+	{
+		Move* moves = data();
+		for (size_t i = 1; i < numMoves; i++)
+		{
+			const Move move = moves[i];
+			const Score staticEval = staticEvals[i];
+			size_t j = i;
+			for (; j > 0 && staticEvals[j - 1] > staticEval; j--)
+			{
+				moves[j] = moves[j - 1];
+				staticEvals[j] = staticEvals[j - 1];
+			}
+
+			moves[j] = move;
+			staticEvals[j] = staticEval;
+		}
+	}
+
+	// Moves the move (and its static evaluation) at index to the front of the list.
+	void moveToFront(size_t index)
+	{
+		assert(index < numMoves);
+		std::swap(data()[0], data()[index]);
+		std::swap(staticEvals[0], staticEvals[index]);
+	}
+
+	Move* begin() { return data(); }
+	Move* end() { return data() + numMoves; }
+	const Move* begin() const { return data(); }
+	const Move* end() const { return data() + numMoves; }
+
+private:
+	Move* data() { return reinterpret_cast<Move*>(storage); }
+	const Move* data() const { return reinterpret_cast<const Move*>(storage); }
+
+	alignas(Move) unsigned char storage[capacity * sizeof(Move)];
+	Score staticEvals[capacity];
+	size_t numMoves = 0;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Move.h"
+#include "MoveList.h"
+#include "SearchHelpers.h"
+
+#include <array>
+
+class Engine;
+class BoardState;
+
+/**
+* Hands out the moves of a position one at a time, in the order they should be searched, and only
+* does the work needed for the moves actually asked for. The stages are:
+* 1. The transposition table move (if it is legal), without generating any moves.
+* 2. Captures and promotions, most valuable victim / least valuable attacker first.
+* 3. The killer moves (if they are legal quiet moves).
+* 4. The remaining quiet moves, sorted by their static evaluation.
+* Since most nodes that are cut off are cut off by one of the first few moves, the quiet moves
+* often never have to be generated or evaluated at all.
+*/
+class MovePicker
+{
+public:
+	// The killer moves are those of the ply in the info.
+	MovePicker(const Engine& engine, BoardState& board, const Move& ttMove,
+		searchHelpers::SearchInfo& info, Depth ply);
+
+	// Returns an unset move when there are no moves left.
+	Move next();
+
+private:
+	enum class Stage
+	{
+		TTMove,
+		GenerateCaptures,
+		Captures,
+		Killers,
+		GenerateQuiets,
+		Quiets,
+		Done
+	};
+
+	void scoreCaptures();
+
+	// True if the move was (or will be) handed out by an earlier stage.
+	bool isTTMoveOrKiller(const Move& move) const;
+
+	const Engine& engine;
+	BoardState& board;
+	searchHelpers::SearchInfo& info;
+	Move ttMove;
+	std::array<Move, searchHelpers::numKillerMoves> killers;
+	Stage stage = Stage::TTMove;
+	MoveList moves;
+	size_t index = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "PiecesAndSquares.h"
+#include "SearchHelpers.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+/**
+* Small direct-mapped cache of pawn structure evaluations, indexed by the pawn hash of the position
+* (see BoardState::getPawnHash()). The pawns rarely change between positions that are close to each
+* other in the search tree, so most lookups are hits even though the table is small enough to stay
+* in the CPU cache. Just like the TranspositionTable, the table can be shared by concurrently
+* searching threads without locking, since a torn entry will simply not be found.
+*/
+class PawnHashTable
+{
+public:
+	static constexpr size_t defaultNumEntries = 16384;
+
+	struct Element
+	{
+		// The score of the terms that only depend on the pawns, from white's point of view.
+		Score score = 0;
+
+		// One bit per file (bit 0 is file A), set if the file has at least one pawn of the color.
+		uint8_t whiteFiles = 0;
+		uint8_t blackFiles = 0;
+	};
+
+	// The number of entries is rounded down to a power of two.
+	PawnHashTable(size_t numEntries = defaultNumEntries);
+
+	std::optional<Element> find(Hash64 pawnHash) const;
+
+	void store(Hash64 pawnHash, const Element& elem);
+
+	void clear();
+
+private:
+	struct Entry
+	{
+		std::atomic<uint64_t> keyXorData{0};
+		std::atomic<uint64_t> data{0};
+	};
+
+	std::unique_ptr<Entry[]> entries;
+	size_t numEntries = 0;
+	Hash64 entryMask = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SearchHelpers.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+/**
+* Hash table of move counts (see EngineAPI::getNumLegalMoves()), indexed by the Zobrist hash of
+* the position and the depth that the moves were counted to. The number of moves only depends on
+* the position, so the counts stay valid for as long as the table lives.
+* Each bucket holds two entries: one that is only replaced by counts of the same or greater depth
+* (which saved the most work), and one that is always replaced. Just like the TranspositionTable,
+* each entry is two atomic words (the data, and the hash xor:ed with the data), so the table can be
+* shared by concurrently counting threads without locking.
+*/
+class PerftTable
+{
+public:
+	PerftTable(size_t sizeMB);
+
+	std::optional<size_t> find(Hash64 hash, Depth depth) const;
+
+	void store(Hash64 hash, Depth depth, size_t numMoves);
+
+	size_t getSizeMB() const { return sizeMB; }
+
+private:
+	struct Entry
+	{
+		std::atomic<uint64_t> keyXorData{0};
+		std::atomic<uint64_t> data{0};
+	};
+
+	struct Bucket
+	{
+		Entry depthPreferred;
+		Entry alwaysReplace;
+	};
+
+	const Bucket& getBucket(Hash64 hash) const { return buckets[hash & bucketMask]; }
+	Bucket& getBucket(Hash64 hash) { return buckets[hash & bucketMask]; }
+
+	std::unique_ptr<Bucket[]> buckets;
+	size_t sizeMB = 0;
+	Hash64 bucketMask = 0;
+};
@@ -32,6 +32,19 @@ namespace pieces
 	};
 }
 
+// Bitmask of the castling moves that are still available.
+typedef uint8_t CastlingRights;
+namespace castlingRights
+{
+	static constexpr CastlingRights none = 0;
+	static constexpr CastlingRights wKingSide = 1;
+	static constexpr CastlingRights wQueenSide = 2;
+	static constexpr CastlingRights bKingSide = 4;
+	static constexpr CastlingRights bQueenSide = 8;
+	static constexpr CastlingRights all = 15;
+	static constexpr size_t num = 16; // Number of possible combinations.
+}
+
 typedef int8_t Square;
 namespace squares
 {
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "PiecesAndSquares.h"
+
+#include <array>
+
+/*
+* Note on terminology: 
+* 'vals' are always positive, thus must be negated for black.
+* 'score' takes color into account, so is already negative for black.
+*/
+
+namespace scoringConstants
+{
+	static constexpr Score pawnProtectingKing1RankAwayVal = 40;
+	static constexpr Score pawnProtectingKing2RanksAwayVal = 20;
+
+	// The minimum number of opponent major pieces that has to be on the board for the king to
+	// be rewarded to be "hidden" to the side of the board behind pawns.
+	static constexpr Score minNumOpponentMajorPieceRewardKingSafety = 2;
+
+	static constexpr Score doublePawnsPunishmentVal = 25;
+	static constexpr Score pawnIslandPunishmentVal = 25;
+
+	static constexpr Score rookOpenFileVal = 40;
+	static constexpr Score trappedRookPenaltyVal = 80;
+
+	static constexpr Score minorPieceProtectedByPawnVal = 10;
+
+	static constexpr Score bishopCoverValPerSquare = 3;
+
+	static constexpr std::array<Score, squares::num>bPawnStaticVals =
+	{
+		180, 180, 180, 200, 200, 180, 180, 180,
+		180, 180, 180, 200, 200, 180, 180, 180,
+		100, 120, 140, 160, 160, 140, 120, 100,
+		100, 110, 120, 140, 140, 120, 110, 100,
+		100, 110, 120, 140, 140, 120, 110, 100,
+		100, 110, 120, 120, 120, 120, 110, 100,
+		100, 110, 110, 110, 110, 110, 110, 100,
+		100, 100, 100, 100, 100, 100, 100, 100
+	};
+
+	static constexpr std::array<Score, squares::num> wPawnStaticVals =
+	{
+		100, 100, 100, 100, 100, 100, 100, 100,
+		100, 110, 110, 110, 110, 110, 110, 100,
+		100, 110, 120, 120, 120, 120, 110, 100,
+		100, 110, 120, 140, 140, 120, 110, 100,
+		100, 110, 120, 140, 140, 120, 110, 100,
+		100, 120, 140, 160, 160, 140, 120, 100,
+		180, 180, 180, 200, 200, 180, 180, 180,
+		180, 180, 180, 200, 200, 180, 180, 180
+	};
+
+	static constexpr std::array<Score, squares::num> bKnightStaticVals =
+	{
+		300, 300, 300, 300, 300, 300, 300, 300,
+		300, 310, 310, 310, 310, 310, 310, 300,
+		300, 310, 320, 320, 320, 320, 310, 300,
+		300, 310, 320, 340, 340, 320, 310, 300,
+		300, 310, 320, 340, 340, 320, 310, 300,
+		300, 310, 320, 320, 320, 320, 310, 300,
+		300, 310, 310, 310, 310, 310, 310, 300,
+		300, 270, 300, 300, 300, 300, 270, 300
+	};
+
+	static constexpr std::array<Score, squares::num> wKnightStaticVals =
+	{
+		300, 270, 300, 300, 300, 300, 270, 300,
+		300, 310, 310, 310, 310, 310, 310, 300,
+		300, 310, 320, 320, 320, 320, 310, 300,
+		300, 310, 320, 340, 340, 320, 310, 300,
+		300, 310, 320, 340, 340, 320, 310, 300,
+		300, 310, 320, 320, 320, 320, 310, 300,
+		300, 310, 310, 310, 310, 310, 310, 300,
+		300, 300, 300, 300, 300, 300, 300, 300
+	};
+
+	static constexpr std::array<Score, squares::num> bBishopStaticVals =
+	{
+		305, 305, 305, 305, 305, 305, 305, 305,
+		305, 315, 315, 315, 315, 315, 315, 305,
+		305, 325, 325, 325, 325, 325, 325, 305,
+		305, 325, 335, 345, 345, 335, 325, 305,
+		305, 325, 335, 345, 345, 335, 325, 305,
+		305, 325, 325, 325, 325, 325, 325, 305,
+		305, 315, 315, 315, 315, 315, 315, 305,
+		305, 305, 275, 305, 305, 275, 305, 305
+	};
+
+	static constexpr std::array<Score, squares::num> wBishopStaticVals =
+	{
+		305, 305, 275, 305, 300, 275, 305, 305,
+		305, 315, 315, 315, 315, 315, 315, 305,
+		305, 325, 325, 325, 325, 325, 325, 305,
+		305, 325, 335, 345, 345, 335, 325, 305,
+		305, 325, 335, 345, 345, 335, 325, 305,
+		305, 325, 325, 325, 325, 325, 325, 305,
+		305, 315, 315, 315, 315, 315, 315, 305,
+		305, 305, 305, 305, 305, 305, 305, 305
+	};
+
+	static constexpr std::array<Score, squares::num> rookStaticVals =
+	{
+		500, 507, 515, 522, 522, 515, 507, 500,
+		500, 507, 515, 522, 522, 515, 507, 500,
+		500, 507, 515, 522, 522, 515, 507, 500,
+		500, 507, 515, 522, 522, 515, 507, 500,
+		500, 507, 515, 522, 522, 515, 507, 500,
+		500, 507, 515, 522, 522, 515, 507, 500,
+		500, 507, 515, 522, 522, 515, 507, 500,
+		500, 507, 515, 522, 522, 515, 507, 500
+	};
+
+	static constexpr std::array<Score, squares::num> bQueenStaticVals =
+	{
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 875, 900, 900, 900, 900
+	};
+
+	static constexpr std::array<Score, squares::num> wQueenStaticVals =
+	{
+		900, 900, 900, 875, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900,
+		900, 900, 900, 900, 900, 900, 900, 900
+	};
+
+	static constexpr std::array<Score, squares::num> bKingEndgameStaticVals =
+	{
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
+		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
+		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
+		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000
+	};
+
+	static constexpr std::array<Score, squares::num> wKingEndgameStaticVals =
+	{
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
+		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
+		10000, 10000, 10040, 10050, 10050, 10040, 10000, 10000,
+		10000, 10000, 10040, 10040, 10040, 10040, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000
+	};
+
+	static constexpr std::array<Score, squares::num> bKingEarlyGameStaticVals =
+	{
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10050, 10050, 10040, 10000, 10000, 10000, 10050, 10050
+	};
+
+	static constexpr std::array<Score, squares::num> wKingEarlyGameStaticVals =
+	{
+		10050, 10050, 10040, 10000, 10000, 10000, 10050, 10050,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000,
+		10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000
+	};
+
+	// The part of the evaluation that only depends on a piece and its square (material plus piece
+	// square value), as a score. The kings are not included, since their values depend on the rest
+	// of the board (see BoardEvaluator).
+	constexpr std::array<std::array<Score, squares::num>, pieces::num> createPieceSquareScores()
+	{
+		std::array<std::array<Score, squares::num>, pieces::num> scores = {};
+		for (Square sq = squares::a1; sq < squares::num; sq++)
+		{
+			scores[pieces::wQ][sq] = wQueenStaticVals[sq];
+			scores[pieces::wR][sq] = rookStaticVals[sq];
+			scores[pieces::wB][sq] = wBishopStaticVals[sq];
+			scores[pieces::wN][sq] = wKnightStaticVals[sq];
+			scores[pieces::wP][sq] = wPawnStaticVals[sq];
+			scores[pieces::bQ][sq] = -bQueenStaticVals[sq];
+			scores[pieces::bR][sq] = -rookStaticVals[sq];
+			scores[pieces::bB][sq] = -bBishopStaticVals[sq];
+			scores[pieces::bN][sq] = -bKnightStaticVals[sq];
+			scores[pieces::bP][sq] = -bPawnStaticVals[sq];
+		}
+
+		return scores;
+	}
+
+	static constexpr std::array<std::array<Score, squares::num>, pieces::num> pieceSquareScores =
+		createPieceSquareScores();
+}
@@ -1,6 +1,14 @@
 #pragma once
 
+#include "Move.h"
+#include "Engine/EngineAPIReturnDefinitions.h"
+#include "Common/StopWatch.h"
+
 #include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
 
 typedef uint8_t Depth;
 typedef int16_t Score;
@@ -12,32 +20,85 @@ namespace searchHelpers
 	static constexpr Score plusInf = 30000;
 	static constexpr Score minusInf = -plusInf;
 
+	// How many nodes that may be visited between each look at the clock.
+	static constexpr uint64_t nodesPerTimeoutCheck = 2048;
+
+	// The number of quiet moves per ply that are remembered for causing a beta cutoff.
+	static constexpr size_t numKillerMoves = 2;
+	static constexpr size_t maxPly = std::numeric_limits<Depth>::max() + 1;
+
+	// If the transposition table statistics are counted (see the HCE_TT_STATS CMake option). When
+	// not, the counting code is compiled out.
+#ifdef HCE_TT_STATS
+	static constexpr bool countTTStats = true;
+#else
+	static constexpr bool countTTStats = false;
+#endif
+
+	// Search state owned by a single search thread.
 	struct SearchInfo
 	{
-		int32_t nodesVisited = 0;
+		uint64_t nodesVisited = 0;
 		int32_t quiescenceMaxDepth = 0;
+		int32_t evalCacheLookups = 0;
+		int32_t evalCacheHits = 0;
+
+		// Only counted if countTTStats is set, the hashfull is not part of the per-thread stats.
+		hceEngine::TranspositionTableInfo ttStats;
+
+		// Shared by all threads of a search. Once set, the search should return as soon as possible.
+		std::atomic<bool>* stop = nullptr;
+
+		// Only set for the thread responsible for stopping the search when the time is up.
+		hceCommon::Stopwatch* stopWatch = nullptr;
+		int32_t timeoutMilliSeconds = std::numeric_limits<int32_t>::max();
+		uint64_t nodesVisitedAtTimeoutCheck = 0;
+
+		// Indexed by the ply (distance from the root), most recent killer first.
+		std::array<std::array<Move, numKillerMoves>, maxPly> killers;
 	};
 
+	// Remembers a quiet move that caused a beta cutoff, so that it can be tried early in other
+	// positions at the same ply.
+	inline void storeKiller(SearchInfo& info, Depth ply, const Move& move)
+	{
+		std::array<Move, numKillerMoves>& killers = info.killers[ply];
+		if (killers[0] != move)
+		{
+			std::move_backward(killers.begin(), killers.end() - 1, killers.end());
+			killers[0] = move;
+		}
+	}
+
+	// Returns true if the search should be stopped. Raises the stop flag if the time is up, but
+	// since reading the clock is slow compared to visiting a node, it is only done once in a while.
+	inline bool shouldStop(SearchInfo& info)
+	{
+		if (info.stopWatch != nullptr &&
+			info.nodesVisited - info.nodesVisitedAtTimeoutCheck >= nodesPerTimeoutCheck)
+		{
+			info.nodesVisitedAtTimeoutCheck = info.nodesVisited;
+			if (info.stopWatch->getMilliseconds() >= info.timeoutMilliSeconds)
+			{
+				info.stop->store(true, std::memory_order_relaxed);
+			}
+		}
+
+		return info.stop != nullptr && info.stop->load(std::memory_order_relaxed);
+	}
+
 	namespace tp
 	{
 		static constexpr int8_t upper = 1;
 		static constexpr int8_t lower = -1;
 		static constexpr int8_t exact = 0;
 
-		// A light-weight struct representing a Move.
-		struct MoveID
-		{
-			Square from = squares::none;
-			Square to = squares::none;
-			bool isSet() const { return from != squares::none; }
-		};
-
 		struct Element
 		{
 			Score score;
 			Depth depth;
 			int8_t type;
-			MoveID bestMove;
+			Move bestMove;
 		};
 	}
 }
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "PiecesAndSquares.h"
+#include "SearchHelpers.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+/**
+* Fixed-size hash table of search results, indexed by the Zobrist hash of the position. The table
+* consists of a power-of-two number of cache line sized buckets, each holding a few entries. A
+* probe or a store only ever touches a single bucket, which makes the cost of a lookup roughly
+* one cache miss (or none, if the bucket was prefetched, see prefetch()). When a bucket is full,
+* entries from previous searches and shallow entries are replaced first.
+* The table can be shared by several concurrently searching threads without locking. Each entry
+* is packed into a single atomic word (holding part of the hash as its key), so an entry can never
+* be torn by two simultaneous stores. This also goes for separate searches
+* running at the same time (e.g. concurrent EngineAPI::getBestMove() calls), which may all call
+* newSearch(); their entries are then simply treated as belonging to the latest search.
+* The buckets are allocated as one block. Large tables are aligned to (and on Linux, advised to
+* be backed by) huge pages, which saves most of the TLB misses of probing a big table. The block is
+* not allocated until allocate() is called (by the first search), so an engine that is resized
+* before it searches never allocates the default size, and one that never searches uses no memory.
+*/
+class TranspositionTable
+{
+public:
+	static constexpr size_t defaultSizeMB = 64;
+
+	TranspositionTable(size_t inSizeMB = defaultSizeMB);
+
+	// Frees the table (which clears it), the next allocate() allocates at most inSizeMB megabytes
+	// of memory. Must not be called while the table is in use.
+	void resize(size_t inSizeMB);
+
+	// Allocates the table, unless that is already done. Must be called before the table is used,
+	// may be called by several threads at once.
+	void allocate();
+
+	// Returns the element stored for the hash, if any.
+	std::optional<searchHelpers::tp::Element> find(Hash64 hash) const;
+
+	// Returns true if the entry of another position was replaced.
+	bool store(Hash64 hash, const searchHelpers::tp::Element& elem);
+
+	// Hints the CPU to start loading the bucket of the hash into the cache.
+	void prefetch(Hash64 hash) const;
+
+	// Entries stored before this call will be the first to be replaced.
+	void newSearch();
+
+	void clear();
+
+	// The per mille of the entries of the current search, estimated from the first buckets.
+	size_t getHashfull() const;
+
+	size_t getNumEntries() const { return numBuckets * entriesPerBucket; }
+
+private:
+	// See toData() in the cpp file for the layout.
+	using Entry = std::atomic<uint64_t>;
+
+	static constexpr size_t cacheLineSize = 64;
+	static constexpr size_t entriesPerBucket = cacheLineSize / sizeof(Entry);
+
+	struct alignas(cacheLineSize) Bucket
+	{
+		std::array<Entry, entriesPerBucket> entries;
+	};
+
+	static_assert(sizeof(Bucket) == cacheLineSize, "A bucket must fill exactly one cache line.");
+
+	const Bucket& getBucket(Hash64 hash) const { return buckets[hash & bucketMask]; }
+	Bucket& getBucket(Hash64 hash) { return buckets[hash & bucketMask]; }
+
+	struct BucketsDeleter
+	{
+		void operator()(Bucket* buckets) const;
+	};
+
+	void allocateBuckets();
+
+	std::unique_ptr<Bucket[], BucketsDeleter> buckets;
+	size_t numBuckets = 0;
+	Hash64 bucketMask = 0;
+	std::atomic<uint8_t> generation{0};
+	size_t sizeMB = 0;
+	std::atomic<bool> isAllocated{false};
+	std::mutex allocationMutex;
+};
@@ -0,0 +1,311 @@
+#include "PrivateInclude/TranspositionTable.h"
+
+#include "PrivateInclude/EngineUtilities.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#include <xmmintrin.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+	// The most common huge page size (on x86-64).
+	static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+	void* allocateAligned(size_t numBytes, size_t alignment)
+	{
+#ifdef _MSC_VER
+		return _aligned_malloc(numBytes, alignment);
+#else
+		return std::aligned_alloc(alignment, numBytes);
+#endif
+	}
+
+	void freeAligned(void* memory)
+	{
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+
+	// The number of bytes is a power of two (times the cache line size), so it is always a multiple
+	// of the alignment used.
+	void* allocateTable(size_t numBytes, size_t cacheLineSize)
+	{
+		if (numBytes >= hugePageSize)
+		{
+			if (void* memory = allocateAligned(numBytes, hugePageSize))
+			{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+				// Only a hint, if transparent huge pages are disabled the table still works the same.
+				madvise(memory, numBytes, MADV_HUGEPAGE);
+#endif
+				return memory;
+			}
+		}
+
+		// Fall back to regular pages.
+		return allocateAligned(numBytes, cacheLineSize);
+	}
+
+	size_t getNumBuckets(size_t sizeMB, size_t bucketSize)
+	{
+		const size_t maxNumBuckets = (sizeMB * 1024 * 1024) / bucketSize;
+
+		// Round down to a power of two so that the bucket index can be found using a bitmask.
+		size_t numBuckets = 1;
+		while (numBuckets * 2 <= maxNumBuckets)
+		{
+			numBuckets *= 2;
+		}
+
+		return numBuckets;
+	}
+
+	// An entry is a single word, so that it can be read and written atomically:
+	// bits 0-15: best move, 16-31: score, 32-39: depth, 40-41: type, 42-47: generation and
+	// 48-63: the upper 16 bits of the hash. Two positions are only mixed up if they share both the
+	// bucket (the lower log2(numBuckets) bits of the hash) and these 16 bits. A probe of a
+	// position that is not in the table compares against up to all the entries of its bucket, so
+	// with a full bucket it finds the entry of another position with a probability of about
+	// entriesPerBucket / 2^16, i.e. roughly once per 8000 such probes. The best move of such an
+	// entry is always checked to be legal before it is played, but its score is used as is, so
+	// a false hit can (rarely) cut off a search with a score from another position. Most engines
+	// accept this, since the score has to survive the depth and bound checks to be used, and a
+	// single wrong node seldom changes the result at the root.
+	static constexpr uint8_t generationBits = 6;
+	static constexpr uint8_t generationMask = (1 << generationBits) - 1;
+
+	uint64_t getKey(Hash64 hash)
+	{
+		return hash >> 48;
+	}
+
+	// The type (tp::lower, tp::exact or tp::upper) is stored in two bits.
+	uint64_t toTypeBits(int8_t type)
+	{
+		return static_cast<uint64_t>(type) & 0x3;
+	}
+
+	int8_t fromTypeBits(uint64_t bits)
+	{
+		return bits == 0x3 ? searchHelpers::tp::lower : static_cast<int8_t>(bits);
+	}
+
+	uint64_t toData(Hash64 hash, const searchHelpers::tp::Element& elem, uint8_t generation)
+	{
+		return static_cast<uint64_t>(elem.bestMove.getData()) |
+			static_cast<uint64_t>(static_cast<uint16_t>(elem.score)) << 16 |
+			static_cast<uint64_t>(elem.depth) << 32 |
+			toTypeBits(elem.type) << 40 |
+			static_cast<uint64_t>(generation & generationMask) << 42 |
+			getKey(hash) << 48;
+	}
+
+	searchHelpers::tp::Element toElement(uint64_t data)
+	{
+		searchHelpers::tp::Element elem;
+		elem.bestMove = Move::fromData(static_cast<uint16_t>(data));
+		elem.score = static_cast<Score>(static_cast<uint16_t>(data >> 16));
+		elem.depth = static_cast<Depth>(data >> 32);
+		elem.type = fromTypeBits((data >> 40) & 0x3);
+		return elem;
+	}
+
+	Depth getDepth(uint64_t data)
+	{
+		return static_cast<Depth>(data >> 32);
+	}
+
+	uint8_t getGeneration(uint64_t data)
+	{
+		return static_cast<uint8_t>(data >> 42) & generationMask;
+	}
+
+	bool isSameKey(uint64_t data, Hash64 hash)
+	{
+		return (data >> 48) == getKey(hash);
+	}
+}
+
+TranspositionTable::TranspositionTable(size_t inSizeMB) : sizeMB{inSizeMB}
+{
+}
+
+void TranspositionTable::resize(size_t inSizeMB)
+{
+	buckets.reset();
+	numBuckets = 0;
+	bucketMask = 0;
+	sizeMB = inSizeMB;
+	isAllocated.store(false, std::memory_order_relaxed);
+}
+
+void TranspositionTable::allocate()
+{
+	if (isAllocated.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(allocationMutex);
+	if (!isAllocated.load(std::memory_order_relaxed))
+	{
+		allocateBuckets();
+		isAllocated.store(true, std::memory_order_release);
+	}
+}
+
+void TranspositionTable::allocateBuckets()
+{
+	numBuckets = getNumBuckets(sizeMB, sizeof(Bucket));
+	void* memory = allocateTable(numBuckets * sizeof(Bucket), cacheLineSize);
+	while (memory == nullptr && numBuckets > 1)
+	{
+		numBuckets /= 2;
+		memory = allocateTable(numBuckets * sizeof(Bucket), cacheLineSize);
+	}
+
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	if (numBuckets < getNumBuckets(sizeMB, sizeof(Bucket)))
+	{
+		EngineUtilities::logW("Could not allocate a transposition table of " +
+			std::to_string(sizeMB) + "MB, using " +
+			std::to_string(numBuckets * sizeof(Bucket) / 1024) + "KB.");
+	}
+
+	buckets.reset(static_cast<Bucket*>(memory));
+	std::uninitialized_value_construct_n(buckets.get(), numBuckets);
+	bucketMask = numBuckets - 1;
+	generation.store(0, std::memory_order_relaxed);
+}
+
+void TranspositionTable::BucketsDeleter::operator()(Bucket* buckets) const
+{
+	// The entries are atomic integers, which need no destruction.
+	freeAligned(buckets);
+}
+
+std::optional<searchHelpers::tp::Element> TranspositionTable::find(Hash64 hash) const
+{
+	for (const Entry& entry : getBucket(hash).entries)
+	{
+		// Note: the search never stores elements of depth 0, so such an entry is an empty one.
+		const uint64_t data = entry.load(std::memory_order_relaxed);
+		if (isSameKey(data, hash) && getDepth(data) > 0)
+		{
+			return toElement(data);
+		}
+	}
+
+	return {};
+}
+
+bool TranspositionTable::store(Hash64 hash, const searchHelpers::tp::Element& elem)
+{
+	assert(elem.depth > 0);
+
+	const uint8_t currentGeneration = generation.load(std::memory_order_relaxed) & generationMask;
+	Bucket& bucket = getBucket(hash);
+	Entry* replace = &bucket.entries[0];
+	uint64_t replaceData = 0;
+	int32_t replaceValue = std::numeric_limits<int32_t>::max();
+	for (Entry& entry : bucket.entries)
+	{
+		const uint64_t data = entry.load(std::memory_order_relaxed);
+		if (isSameKey(data, hash) || getDepth(data) == 0)
+		{
+			// Same position (or an empty entry), always use this one.
+			replace = &entry;
+			replaceData = data;
+			break;
+		}
+
+		// Prefer to replace entries from older searches, and then the most shallow ones.
+		const int32_t value = getDepth(data) + (getGeneration(data) == currentGeneration ? 256 : 0);
+		if (value < replaceValue)
+		{
+			replace = &entry;
+			replaceData = data;
+			replaceValue = value;
+		}
+	}
+
+	searchHelpers::tp::Element newElem = elem;
+	if (!newElem.bestMove.isSet() && isSameKey(replaceData, hash) && getDepth(replaceData) > 0)
+	{
+		// Keep any previously known best move, it is still good for move ordering.
+		newElem.bestMove = toElement(replaceData).bestMove;
+	}
+
+	replace->store(toData(hash, newElem, currentGeneration), std::memory_order_relaxed);
+	return getDepth(replaceData) > 0 && !isSameKey(replaceData, hash);
+}
+
+void TranspositionTable::prefetch(Hash64 hash) const
+{
+#ifdef _MSC_VER
+	_mm_prefetch(reinterpret_cast<const char*>(&getBucket(hash)), _MM_HINT_T0);
+#else
+	__builtin_prefetch(&getBucket(hash));
+#endif
+}
+
+void TranspositionTable::newSearch()
+{
+	generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+	for (size_t i = 0; i < numBuckets; i++)
+	{
+		for (Entry& entry : buckets[i].entries)
+		{
+			entry.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	generation.store(0, std::memory_order_relaxed);
+}
+
+size_t TranspositionTable::getHashfull() const
+{
+	static constexpr size_t sampleSize = 1000;
+	const uint8_t currentGeneration = generation.load(std::memory_order_relaxed) & generationMask;
+	const size_t numSampled = std::min(sampleSize, getNumEntries());
+	if (numSampled == 0)
+	{
+		// Not allocated yet.
+		return 0;
+	}
+
+	size_t numUsed = 0;
+	for (size_t i = 0; i < numSampled; i++)
+	{
+		const uint64_t data =
+			buckets[i / entriesPerBucket].entries[i % entriesPerBucket].load(std::memory_order_relaxed);
+		if (getDepth(data) > 0 && getGeneration(data) == currentGeneration)
+		{
+			numUsed++;
+		}
+	}
+
+	return numUsed * 1000 / numSampled;
+}
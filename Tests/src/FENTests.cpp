@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <string>
 #include <cassert>
+#include <algorithm>
+#include <thread>
 
 namespace testHelpers
 {
@@ -159,6 +161,41 @@ namespace testHelpers
 		// Key is depth, value is number of moves.
 		std::unordered_map<uint8_t, size_t> numMoves;
 	};
+
+	// Checks that the number of moves per legal move adds up to the expected total.
+	bool testNumLegalMovesPerMove(const hceEngine::EngineAPI& engine, uint8_t depth,
+		uint32_t numThreads, size_t hashSizeMB)
+	{
+		for (size_t i = 0; i < FENTestsStrVector.size(); i++)
+		{
+			const FENTestParams params(FENTestsStrVector[i]);
+			const auto movesPerMove = engine.getNumLegalMovesPerMove(params.FEN, depth, numThreads,
+				hashSizeMB);
+			if (!movesPerMove || movesPerMove->size() != params.numMoves.find(1)->second)
+			{
+				TestsUtilities::logE("FEN per move test failed, wrong number of moves for test "
+					"number: " + std::to_string(i));
+				return false;
+			}
+
+			size_t numMoves = 0;
+			for (const hceEngine::MoveCount& moveCount : *movesPerMove)
+			{
+				numMoves += moveCount.numLegalMoves;
+			}
+
+			if (numMoves != params.numMoves.find(depth)->second)
+			{
+				TestsUtilities::logE("FEN per move test failed with test number: " +
+					std::to_string(i) + " depth: " + std::to_string(depth) + ". Expected num moves: "
+					+ std::to_string(params.numMoves.find(depth)->second) + " but got: " +
+					std::to_string(numMoves));
+				return false;
+			}
+		}
+
+		return true;
+	}
 }
 
 void FENTests::Run()
@@ -169,14 +206,18 @@ void FENTests::Run()
 	hceCommon::Stopwatch stopWatch;
 	stopWatch.start();
 
-	static const uint8_t maxDepth = TestsUtilities::isReleaseBuild() ? 5 : 3;
+	// Depth 6 is only reachable in reasonable time thanks to the hash table, which also gets its
+	// share of positions reached through transpositions this way.
+	static const uint8_t maxDepth = TestsUtilities::isReleaseBuild() ? 6 : 3;
+	const uint32_t numThreads = std::max(std::thread::hardware_concurrency(), 2u);
+	static const size_t hashSizeMB = TestsUtilities::isReleaseBuild() ? 256 : 64;
 	for (size_t depth = 1; depth <= maxDepth; depth++)
 	{
 		for (size_t i = 0; i < testHelpers::FENTestsStrVector.size(); i++)
 		{
 			const std::string test = testHelpers::FENTestsStrVector[i];
 			const testHelpers::FENTestParams params(test);
-			const auto numMoves = engine.getNumLegalMoves(params.FEN, depth);
+			const auto numMoves = engine.getNumLegalMoves(params.FEN, depth, numThreads, hashSizeMB);
 
 			if (!numMoves)
 			{
@@ -200,6 +241,19 @@ void FENTests::Run()
 	}
 
 	int32_t mills = stopWatch.getMilliseconds();
+	if (!testHelpers::testNumLegalMovesPerMove(engine, 3, numThreads, 0))
+	{
+		return;
+	}
+
+	// The hash table is still filled by the counts above, so this also tests counting with a table
+	// kept from earlier calls.
+	if (!testHelpers::testNumLegalMovesPerMove(engine, 4, numThreads, hashSizeMB))
+	{
+		return;
+	}
+
+	TestsUtilities::log("FEN per move tests succeeded.");
 	TestsUtilities::log("All FEN Tests finished successfully. Generated: " + std::to_string(numMovesSum)
 		+ " moves in: " + std::to_string(mills) + " ms, or: " +
 		std::to_string((numMovesSum / std::max(mills,1)) * 1000) + " moves per second.");
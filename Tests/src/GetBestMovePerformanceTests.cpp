@@ -5,9 +5,34 @@
 #include "Common/StopWatch.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 namespace
 {
+	std::string getTranspositionTableInfoStr(const hceEngine::TranspositionTableInfo& info)
+	{
+		std::string str = "Transposition table hashfull: " + std::to_string(info.hashfull) +
+			" per mille.\n";
+		if (info.probes > 0)
+		{
+			// Only counted when the engine is built with the HCE_TT_STATS option.
+			str += "Transposition table probes: " + std::to_string(info.probes) + ", hits: " +
+				std::to_string(info.hits) + " (usable: " + std::to_string(info.usableHits) +
+				", cutoffs: " + std::to_string(info.cutoffs) + ", illegal moves: " +
+				std::to_string(info.illegalTTMoves) + "), stores: " + std::to_string(info.stores) +
+				" (replacements: " + std::to_string(info.replacements) + ").\n";
+		}
+
+		return str;
+	}
+
 	void printResut(const std::string& positionName, const hceEngine::SearchResult& result,
 		int32_t milliseconds)
 	{
@@ -20,7 +45,9 @@ namespace
 			std::to_string(nodes) +
 			+" which is: " + std::to_string((nodes / std::max(milliseconds, 1)) * 1000) + " nodes "
 			+ "visited per second. Best move score: " + std::to_string(result.move.positionEvaluation)
-			+ "\n");
+			+ "\nEvaluation cache hit rate: " +
+			std::to_string(static_cast<int32_t>(result.engineInfo.evalCacheHitRate * 100.f)) + "%\n"
+			+ getTranspositionTableInfoStr(result.engineInfo.transpositionTable));
 	}
 
 	void testEndGameAnalysisPerformance(const hceEngine::EngineAPI& engine, uint8_t depth)
@@ -56,6 +83,171 @@ namespace
 		printResut("Late mid-game position", res, lateMidgameTime);
 	}
 
+	void testRepeatedMidGameAnalysisPerformance(const hceEngine::EngineAPI& engine, uint8_t depth)
+	{
+		// Test that a second search of the same position benefits from the first one.
+		hceCommon::Stopwatch stopwatch;
+		static const std::string midgamePos = "r3k2r/pppqbppp/2npbn2/4p3/4P3/2NPBN2/PPPQBPPP/R3K2R w KQkq - 0 1";
+		stopwatch.start();
+		const auto res = engine.getBestMove(midgamePos, depth);
+		const int32_t midgameTime = stopwatch.getMilliseconds();
+		printResut("Mid-game position (repeated search)", res, midgameTime);
+	}
+
+	void testMultiThreadedMidGameAnalysisPerformance(const hceEngine::EngineAPI& engine, uint8_t depth)
+	{
+		// Test mid-game position alpha-beta with quiescence search performance, using all cores.
+		hceCommon::Stopwatch stopwatch;
+		static const std::string midgamePos = "r3k2r/pppqbppp/2npbn2/4p3/4P3/2NPBN2/PPPQBPPP/R3K2R w KQkq - 0 1";
+		const uint32_t numThreads = std::max(std::thread::hardware_concurrency(), 2u);
+		stopwatch.start();
+		const auto res = engine.getBestMove(midgamePos, depth,
+			std::numeric_limits<int32_t>::max(), numThreads);
+		const int32_t midgameTime = stopwatch.getMilliseconds();
+		printResut("Mid-game position (" + std::to_string(numThreads) + " threads)", res,
+			midgameTime);
+
+		if (res.move.type == hceEngine::MoveType::Invalid ||
+			res.move.type == hceEngine::MoveType::None ||
+			res.engineInfo.depthsCompletelyCovered != depth)
+		{
+			TestsUtilities::logE("Multi-threaded search of position: " + midgamePos + " failed.");
+			return;
+		}
+
+		// The threads share the transposition table, so a thread may use results of other threads
+		// searched deeper than it would have itself, which can (rarely) change the outcome.
+		hceEngine::EngineAPI singleThreadedEngine;
+		const auto singleThreadedRes = singleThreadedEngine.getBestMove(midgamePos, depth);
+		if (res.move.fromSquare != singleThreadedRes.move.fromSquare ||
+			res.move.toSquare != singleThreadedRes.move.toSquare ||
+			res.move.positionEvaluation != singleThreadedRes.move.positionEvaluation)
+		{
+			TestsUtilities::logW("Multi-threaded search found: " + res.move.fromSquare +
+				res.move.toSquare + " (" + std::to_string(res.move.positionEvaluation) +
+				") but single-threaded search found: " + singleThreadedRes.move.fromSquare +
+				singleThreadedRes.move.toSquare + " (" +
+				std::to_string(singleThreadedRes.move.positionEvaluation) + ").");
+		}
+	}
+
+	void testConcurrentAnalysisPerformance(const hceEngine::EngineAPI& engine, uint8_t depth)
+	{
+		// Test several positions analyzed at the same time by the same engine, sharing its hash.
+		static const std::vector<std::string> positions = {
+			"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+			"r3k2r/pppqbppp/2npbn2/4p3/4P3/2NPBN2/PPPQBPPP/R3K2R w KQkq - 0 1",
+			"4r1k1/p4ppp/1rp1pnb1/3p4/P2P4/2QBP3/1PPN1PPP/6K1 w - - 0 1",
+			"4k3/p1p1pp2/4b3/3p4/3P4/P7/1P2PP2/1N2K3 w - - 0 1"};
+		hceCommon::Stopwatch stopwatch;
+		std::vector<hceEngine::SearchResult> results(positions.size());
+		std::vector<std::thread> threads;
+		stopwatch.start();
+		for (size_t i = 0; i < positions.size(); i++)
+		{
+			threads.emplace_back([&engine, &results, i, depth]() {
+				results[i] = engine.getBestMove(positions[i], depth);
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		const int32_t time = stopwatch.getMilliseconds();
+		size_t nodes = 0;
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			nodes += results[i].engineInfo.nodesVisited;
+			if (results[i].move.type == hceEngine::MoveType::Invalid ||
+				results[i].move.type == hceEngine::MoveType::None ||
+				results[i].engineInfo.depthsCompletelyCovered != depth)
+			{
+				TestsUtilities::logE("Concurrent search of position: " + positions[i] + " failed.");
+			}
+		}
+
+		TestsUtilities::log(std::to_string(positions.size()) + " positions analyzed concurrently "
+			"to depth: " + std::to_string(depth) + " took: " + std::to_string(time) + "ms.\n"
+			"Number of nodes visited: " + std::to_string(nodes) + "\n");
+	}
+
+#ifndef _WIN32
+	void testAnalysisCachePerformance(uint8_t depth)
+	{
+		// Test that a search is remembered by a new engine (as after a restart of the program)
+		// sharing the same analysis cache file.
+		static const std::string midgamePos = "r3k2r/pppqbppp/2npbn2/4p3/4P3/2NPBN2/PPPQBPPP/R3K2R w KQkq - 0 1";
+
+		// The process id keeps test runs at the same time from using each others files.
+		const std::string path = (std::filesystem::temp_directory_path() /
+			("hce_analysis_cache_test_" + std::to_string(getpid()) + ".bin")).string();
+		std::remove(path.c_str());
+
+		hceEngine::SearchResult firstResult;
+		{
+			hceEngine::EngineAPI firstEngine;
+			if (!firstEngine.openAnalysisCache(path, 16))
+			{
+				TestsUtilities::logE("Could not open the analysis cache file: " + path);
+				return;
+			}
+
+			firstResult = firstEngine.getBestMove(midgamePos, depth);
+		}
+
+		hceEngine::EngineAPI secondEngine;
+		if (!secondEngine.openAnalysisCache(path, 16))
+		{
+			TestsUtilities::logE("Could not reopen the analysis cache file: " + path);
+			std::remove(path.c_str());
+			return;
+		}
+
+		hceCommon::Stopwatch stopwatch;
+		stopwatch.start();
+		const auto res = secondEngine.getBestMove(midgamePos, depth);
+		const int32_t midgameTime = stopwatch.getMilliseconds();
+		printResut("Mid-game position (from the analysis cache)", res, midgameTime);
+		secondEngine.closeAnalysisCache();
+		std::remove(path.c_str());
+
+		if (res.move.fromSquare != firstResult.move.fromSquare ||
+			res.move.toSquare != firstResult.move.toSquare ||
+			res.engineInfo.depthsCompletelyCovered < depth || res.engineInfo.nodesVisited != 0)
+		{
+			TestsUtilities::logE("The search result was not found in the analysis cache.");
+		}
+	}
+#endif
+
+	void testMidGameAnalysisTimeout(const hceEngine::EngineAPI& engine)
+	{
+		// Test that a search too deep to ever finish still returns (with a move) in time.
+		hceCommon::Stopwatch stopwatch;
+		static const std::string midgamePos = "r3k2r/pppqbppp/2npbn2/4p3/4P3/2NPBN2/PPPQBPPP/R3K2R w KQkq - 0 1";
+		static constexpr int32_t timeout = 1000;
+		static const int32_t maxOverrun = TestsUtilities::isReleaseBuild() ? 100 : 500;
+		stopwatch.start();
+		const auto res = engine.getBestMove(midgamePos, 30, timeout);
+		const int32_t midgameTime = stopwatch.getMilliseconds();
+		printResut("Mid-game position (" + std::to_string(timeout) + "ms timeout)", res,
+			midgameTime);
+
+		if (midgameTime > timeout + maxOverrun)
+		{
+			TestsUtilities::logE("Search with timeout: " + std::to_string(timeout) + "ms took: " +
+				std::to_string(midgameTime) + "ms.");
+		}
+
+		if (res.move.type == hceEngine::MoveType::Invalid ||
+			res.move.type == hceEngine::MoveType::None)
+		{
+			TestsUtilities::logE("Search with timeout did not return a valid move.");
+		}
+	}
+
 	void testStartPosAnalysisPerformance(const hceEngine::EngineAPI& engine, uint8_t depth)
 	{
 		// Test starting position (fast) alpha-beta with quiescence search performance.
@@ -77,9 +269,24 @@ void GetBestMovePerformanceTests::Run()
 	static const uint8_t midgameDepth = TestsUtilities::isReleaseBuild() ? 8 : 4;
 	static const uint8_t lateMidgameDepth = TestsUtilities::isReleaseBuild() ? 9 : 5;
 	static const uint8_t endgameDepth = TestsUtilities::isReleaseBuild() ? 10 : 5;
+	static const uint8_t concurrentDepth = TestsUtilities::isReleaseBuild() ? 7 : 4;
 	testStartPosAnalysisPerformance(engine, startPosDepth);
+	engine.clearHash();
 	testMidGameAnalysisPerformance(engine, midgameDepth);
+	testRepeatedMidGameAnalysisPerformance(engine, midgameDepth);
+	engine.clearHash();
+	testMultiThreadedMidGameAnalysisPerformance(engine, midgameDepth);
+	engine.clearHash();
+#ifndef _WIN32
+	testAnalysisCachePerformance(midgameDepth);
+#endif
+	testMidGameAnalysisTimeout(engine);
+	engine.clearHash();
+	engine.setHashSizeMB(256);
+	testConcurrentAnalysisPerformance(engine, concurrentDepth);
+	engine.clearHash();
 	testLateMidGameAnalysisPerformance(engine, lateMidgameDepth);
+	engine.clearHash();
 	testEndGameAnalysisPerformance(engine, endgameDepth);
 
 	TestsUtilities::log("All get best move performance tests done.");